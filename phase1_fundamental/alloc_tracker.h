@@ -0,0 +1,361 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// In-process allocation tracker: a cheap alternative to a Valgrind run.
+//
+// Define MEMORY_TRACKER in exactly one translation unit before including
+// this header (or pass -DMEMORY_TRACKER) to replace the global operator
+// new/delete. Every block then carries a 16-byte header with its size and
+// the call site that allocated it, and each thread counts allocations in
+// its own counters. Nothing is shared on the hot path; snapshot() and
+// report() add the per-thread counters up when asked.
+//
+// Without MEMORY_TRACKER the API still compiles, `enabled` is false and
+// every counter reads zero, so test code can use Scope unconditionally.
+namespace alloc_tracker {
+
+#ifdef MEMORY_TRACKER
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+struct Stats {
+    int64_t live_bytes = 0;
+    int64_t live_blocks = 0;
+    int64_t peak_bytes = 0;     // exact single-threaded, else see flush_threshold
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+};
+
+struct CallSite {
+    uintptr_t address;
+    uint64_t allocations;
+    uint64_t bytes;
+    int64_t live_blocks;
+    int64_t live_bytes;
+};
+
+namespace detail {
+
+// Only the owning thread writes these, so plain load+store is enough; the
+// atomics make concurrent reads from snapshot() well defined.
+struct Counter {
+    std::atomic<int64_t> value{0};
+
+    void add(int64_t delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    int64_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+struct SiteEntry {
+    std::atomic<uintptr_t> address{0};
+    Counter allocations;
+    Counter bytes;
+    Counter live_blocks;
+    Counter live_bytes;
+};
+
+constexpr size_t SITE_TABLE_SIZE = 256;     // per thread, open addressing
+
+struct ThreadState {
+    Counter allocations;
+    Counter frees;
+    Counter alloc_bytes;
+    Counter free_bytes;
+    Counter peak_bytes;         // high-water mark of this thread's net bytes
+    int64_t unflushed = 0;      // net bytes not yet added to the global total
+    SiteEntry sites[SITE_TABLE_SIZE];
+    ThreadState* next = nullptr;
+};
+
+// Global totals are only touched when a thread's net change crosses this
+// many bytes, which keeps the shared cache line cold. Peak usage is
+// therefore accurate to within threads * flush_threshold.
+constexpr int64_t flush_threshold = 64 * 1024;
+
+// All thread states ever created. States are never freed: a thread may
+// still free memory from thread_local destructors after it "exits".
+inline std::atomic<ThreadState*> all_threads{nullptr};
+inline std::atomic<int64_t> global_live{0};
+inline std::atomic<int64_t> global_peak{0};
+
+inline ThreadState* create_thread_state() {
+    // malloc, not new: we are inside operator new.
+    void* raw = std::malloc(sizeof(ThreadState));
+    if (!raw) {
+        std::abort();
+    }
+    ThreadState* state = new (raw) ThreadState();
+    ThreadState* head = all_threads.load(std::memory_order_relaxed);
+    do {
+        state->next = head;
+    } while (!all_threads.compare_exchange_weak(head, state, std::memory_order_release,
+                                                std::memory_order_relaxed));
+    return state;
+}
+
+inline ThreadState& this_thread() {
+    thread_local ThreadState* state = nullptr;
+    if (!state) {
+        state = create_thread_state();
+    }
+    return *state;
+}
+
+inline SiteEntry& site_entry(ThreadState& state, uintptr_t address) {
+    size_t index = (address >> 4) * 0x9E3779B97F4A7C15ull >> 56;
+    for (size_t probe = 0; probe < SITE_TABLE_SIZE; ++probe) {
+        SiteEntry& entry = state.sites[(index + probe) % SITE_TABLE_SIZE];
+        uintptr_t current = entry.address.load(std::memory_order_relaxed);
+        if (current == address) {
+            return entry;
+        }
+        if (current == 0) {
+            entry.address.store(address, std::memory_order_relaxed);
+            return entry;
+        }
+    }
+    // Table full: charge the last slot ("other sites").
+    return state.sites[SITE_TABLE_SIZE - 1];
+}
+
+inline void flush(ThreadState& state) {
+    int64_t live = global_live.fetch_add(state.unflushed, std::memory_order_relaxed) + state.unflushed;
+    state.unflushed = 0;
+    int64_t peak = global_peak.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !global_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+// Block header; 16 bytes so the user pointer keeps malloc's alignment.
+struct Header {
+    size_t size;
+    uintptr_t site;
+};
+static_assert(sizeof(Header) == 16, "header must preserve 16-byte alignment");
+
+inline void* tracked_allocate(size_t size, uintptr_t site) {
+    Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+    if (!header) {
+        return nullptr;
+    }
+    header->size = size;
+    header->site = site;
+
+    ThreadState& state = this_thread();
+    state.allocations.add(1);
+    state.alloc_bytes.add(static_cast<int64_t>(size));
+    SiteEntry& entry = site_entry(state, site);
+    entry.allocations.add(1);
+    entry.bytes.add(static_cast<int64_t>(size));
+    entry.live_blocks.add(1);
+    entry.live_bytes.add(static_cast<int64_t>(size));
+    int64_t net = state.alloc_bytes.get() - state.free_bytes.get();
+    if (net > state.peak_bytes.get()) {
+        state.peak_bytes.value.store(net, std::memory_order_relaxed);
+    }
+    state.unflushed += static_cast<int64_t>(size);
+    if (state.unflushed > flush_threshold) {
+        flush(state);
+    }
+    return header + 1;
+}
+
+inline void tracked_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    Header* header = static_cast<Header*>(ptr) - 1;
+    ThreadState& state = this_thread();
+    state.frees.add(1);
+    state.free_bytes.add(static_cast<int64_t>(header->size));
+    SiteEntry& entry = site_entry(state, header->site);
+    entry.live_blocks.add(-1);
+    entry.live_bytes.add(-static_cast<int64_t>(header->size));
+    state.unflushed -= static_cast<int64_t>(header->size);
+    if (state.unflushed < -flush_threshold) {
+        flush(state);
+    }
+    std::free(header);
+}
+
+} // namespace detail
+
+// Totals across every thread, added up now.
+inline Stats snapshot() {
+    Stats stats;
+    stats.peak_bytes = detail::global_peak.load(std::memory_order_relaxed);
+    for (auto* state = detail::all_threads.load(std::memory_order_acquire); state; state = state->next) {
+        stats.allocations += static_cast<uint64_t>(state->allocations.get());
+        stats.frees += static_cast<uint64_t>(state->frees.get());
+        stats.live_bytes += state->alloc_bytes.get() - state->free_bytes.get();
+        stats.peak_bytes = std::max(stats.peak_bytes, state->peak_bytes.get());
+    }
+    stats.live_blocks = static_cast<int64_t>(stats.allocations - stats.frees);
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.live_bytes);
+    return stats;
+}
+
+// Net allocations made by the current thread inside a scope. Exact as long
+// as the blocks are allocated and freed on this thread.
+class Scope {
+private:
+    int64_t start_allocations = 0;
+    int64_t start_frees = 0;
+    int64_t start_bytes = 0;
+
+    static int64_t net_bytes_now() {
+        if (!enabled) {
+            return 0;
+        }
+        detail::ThreadState& state = detail::this_thread();
+        return state.alloc_bytes.get() - state.free_bytes.get();
+    }
+
+    static int64_t count(bool allocations) {
+        if (!enabled) {
+            return 0;
+        }
+        detail::ThreadState& state = detail::this_thread();
+        return allocations ? state.allocations.get() : state.frees.get();
+    }
+
+public:
+    Scope()
+        : start_allocations(count(true)), start_frees(count(false)), start_bytes(net_bytes_now()) {}
+
+    int64_t allocations() const { return count(true) - start_allocations; }
+    int64_t net_blocks() const { return allocations() - (count(false) - start_frees); }
+    int64_t net_bytes() const { return net_bytes_now() - start_bytes; }
+};
+
+// Call sites across all threads, sorted by live bytes, then total bytes.
+inline std::vector<CallSite> call_sites() {
+    std::vector<CallSite> merged;
+    for (auto* state = detail::all_threads.load(std::memory_order_acquire); state; state = state->next) {
+        for (const auto& entry : state->sites) {
+            uintptr_t address = entry.address.load(std::memory_order_relaxed);
+            if (!address) {
+                continue;
+            }
+            auto it = std::find_if(merged.begin(), merged.end(),
+                                   [&](const CallSite& site) { return site.address == address; });
+            if (it == merged.end()) {
+                merged.push_back(CallSite{address, 0, 0, 0, 0});
+                it = merged.end() - 1;
+            }
+            it->allocations += static_cast<uint64_t>(entry.allocations.get());
+            it->bytes += static_cast<uint64_t>(entry.bytes.get());
+            it->live_blocks += entry.live_blocks.get();
+            it->live_bytes += entry.live_bytes.get();
+        }
+    }
+    std::sort(merged.begin(), merged.end(), [](const CallSite& a, const CallSite& b) {
+        return a.live_bytes != b.live_bytes ? a.live_bytes > b.live_bytes : a.bytes > b.bytes;
+    });
+    return merged;
+}
+
+// "function+0xoffset" for a code address, demangled when possible. Symbols
+// of the main program are only visible when it is linked with -rdynamic;
+// otherwise this gives "binary+0xoffset", which addr2line -f -C -e binary
+// turns into a function and line. Without `with_offset` a resolved symbol
+// is just the function name, so every address inside it maps to one string.
+inline std::string symbolize(uintptr_t address, bool with_offset = true) {
+    Dl_info info;
+    char buffer[64];
+    if (!dladdr(reinterpret_cast<void*>(address), &info)) {
+        std::snprintf(buffer, sizeof(buffer), "0x%lx", static_cast<unsigned long>(address));
+        return buffer;
+    }
+    if (!info.dli_sname) {
+        std::snprintf(buffer, sizeof(buffer), "+0x%lx",
+                      static_cast<unsigned long>(address - reinterpret_cast<uintptr_t>(info.dli_fbase)));
+        return std::string(info.dli_fname ? info.dli_fname : "?") + buffer;
+    }
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+    std::free(demangled);
+    if (!with_offset) {
+        return name;
+    }
+    std::snprintf(buffer, sizeof(buffer), "+0x%lx",
+                  static_cast<unsigned long>(address - reinterpret_cast<uintptr_t>(info.dli_saddr)));
+    return name + buffer;
+}
+
+inline void report(std::ostream& out, size_t top_sites = 10) {
+    if (!enabled) {
+        out << "alloc_tracker: not compiled in (build with -DMEMORY_TRACKER)\n";
+        return;
+    }
+    Stats stats = snapshot();
+    std::vector<CallSite> sites = call_sites();
+    out << "alloc_tracker: " << stats.allocations << " allocations, " << stats.frees << " frees, "
+        << stats.live_blocks << " live blocks / " << stats.live_bytes << " live bytes, peak ~"
+        << stats.peak_bytes << " bytes\n";
+    for (size_t i = 0; i < sites.size() && i < top_sites; ++i) {
+        const CallSite& site = sites[i];
+        out << "  " << site.live_bytes << " live bytes in " << site.live_blocks << " blocks, "
+            << site.allocations << " allocations / " << site.bytes << " bytes total at "
+            << symbolize(site.address) << "\n";
+    }
+}
+
+} // namespace alloc_tracker
+
+#ifdef MEMORY_TRACKER
+
+#define ALLOC_TRACKER_SITE reinterpret_cast<uintptr_t>(__builtin_return_address(0))
+
+void* operator new(size_t size) {
+    void* ptr = alloc_tracker::detail::tracked_allocate(size, ALLOC_TRACKER_SITE);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = alloc_tracker::detail::tracked_allocate(size, ALLOC_TRACKER_SITE);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracker::detail::tracked_allocate(size, ALLOC_TRACKER_SITE);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracker::detail::tracked_allocate(size, ALLOC_TRACKER_SITE);
+}
+
+void operator delete(void* ptr) noexcept { alloc_tracker::detail::tracked_free(ptr); }
+void operator delete[](void* ptr) noexcept { alloc_tracker::detail::tracked_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { alloc_tracker::detail::tracked_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { alloc_tracker::detail::tracked_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { alloc_tracker::detail::tracked_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { alloc_tracker::detail::tracked_free(ptr); }
+
+#undef ALLOC_TRACKER_SITE
+
+#endif
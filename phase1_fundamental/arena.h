@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Monotonic bump allocator for allocations that all die together.
+//
+// Memory is carved from large blocks by bumping a pointer; individual
+// objects are never freed. Instead the arena is rewound to a Checkpoint (or
+// reset() to empty) in O(1): blocks are kept and reused by later
+// allocations, and only the destructor returns them upstream.
+//
+// create<T>() registers T's destructor when T is not trivially
+// destructible; rewinding runs the destructors of everything created after
+// the checkpoint, newest first.
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        size_t bytes;       // usable bytes after the header
+    };
+
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* prev;
+    };
+
+    static constexpr size_t HEADER = (sizeof(Block) + alignof(std::max_align_t) - 1)
+                                     / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    size_t block_size;
+    std::pmr::memory_resource* upstream;
+
+    Block* first = nullptr;
+    Block* current = nullptr;
+    char* ptr = nullptr;
+    char* end = nullptr;
+    Finalizer* finalizers = nullptr;
+    size_t reserved_bytes = 0;
+
+    static char* data(Block* block) {
+        return reinterpret_cast<char*>(block) + HEADER;
+    }
+
+    static char* align_up(char* p, size_t align) {
+        uintptr_t value = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((value + align - 1) & ~(uintptr_t(align) - 1));
+    }
+
+    // Slow path: move to the next kept block that fits, or add a new one
+    // right after the current block.
+    void* allocate_slow(size_t bytes, size_t align) {
+        size_t needed = bytes + align - 1;
+        Block* next = current ? current->next : first;
+        while (next && next->bytes < needed) {
+            next = next->next;
+        }
+        if (!next) {
+            size_t usable = std::max(block_size, needed);
+            next = static_cast<Block*>(upstream->allocate(HEADER + usable, alignof(std::max_align_t)));
+            next->bytes = usable;
+            reserved_bytes += HEADER + usable;
+            if (current) {
+                next->next = current->next;
+                current->next = next;
+            } else {
+                next->next = first;
+                first = next;
+            }
+        }
+        current = next;
+        ptr = data(current);
+        end = ptr + current->bytes;
+
+        char* result = align_up(ptr, align);
+        ptr = result + bytes;
+        return result;
+    }
+
+    void run_finalizers(Finalizer* stop) {
+        while (finalizers != stop) {
+            Finalizer* finalizer = finalizers;
+            finalizers = finalizer->prev;
+            finalizer->destroy(finalizer->object);
+        }
+    }
+
+public:
+    // Position to rewind to. Only valid for the arena that produced it and
+    // only while no earlier checkpoint has been rewound past it.
+    struct Checkpoint {
+        Block* block;
+        char* ptr;
+        char* end;
+        Finalizer* finalizers;
+    };
+
+    // Rewinds the arena to where it was when the scope was entered.
+    class Scope {
+    private:
+        Arena& arena;
+        Checkpoint mark;
+
+    public:
+        explicit Scope(Arena& owner) : arena(owner), mark(owner.checkpoint()) {}
+        ~Scope() { arena.rewind(mark); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    explicit Arena(size_t block_bytes = 64 * 1024,
+                   std::pmr::memory_resource* upstream_resource = std::pmr::new_delete_resource())
+        : block_size(block_bytes), upstream(upstream_resource) {}
+
+    ~Arena() {
+        run_finalizers(nullptr);
+        while (first) {
+            Block* next = first->next;
+            upstream->deallocate(first, HEADER + first->bytes, alignof(std::max_align_t));
+            first = next;
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        char* result = align_up(ptr, align);
+        if (ptr && result <= end && bytes <= static_cast<size_t>(end - result)) {
+            ptr = result + bytes;
+            return result;
+        }
+        return allocate_slow(bytes, align);
+    }
+
+    // Uninitialized storage for `count` objects of trivial type T.
+    template<typename T>
+    T* allocate_array(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "allocate_array does not run destructors; use create<T>() instead");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        } else {
+            // Reserve the finalizer first so registering it can't fail after
+            // the object exists.
+            void* node = allocate(sizeof(Finalizer), alignof(Finalizer));
+            T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            finalizers = new (node) Finalizer{
+                [](void* p) { static_cast<T*>(p)->~T(); }, object, finalizers};
+            return object;
+        }
+    }
+
+    Checkpoint checkpoint() const {
+        return Checkpoint{current, ptr, end, finalizers};
+    }
+
+    void rewind(const Checkpoint& mark) {
+        run_finalizers(mark.finalizers);
+        if (!mark.block && first) {
+            // Back to empty: restart in the first kept block so the next
+            // allocation stays on the fast path.
+            current = first;
+            ptr = data(first);
+            end = ptr + first->bytes;
+            return;
+        }
+        current = mark.block;
+        ptr = mark.ptr;
+        end = mark.end;
+    }
+
+    void reset() {
+        rewind(Checkpoint{nullptr, nullptr, nullptr, nullptr});
+    }
+
+    // Bytes held from upstream, including blocks kept for reuse.
+    size_t reserved() const { return reserved_bytes; }
+};
+
+// std::pmr::memory_resource view of an Arena, for containers that take a
+// resource. deallocate() does nothing: the memory comes back when the
+// arena is rewound or reset.
+class ArenaResource final : public std::pmr::memory_resource {
+private:
+    Arena& arena;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override { return arena.allocate(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+public:
+    explicit ArenaResource(Arena& owner) : arena(owner) {}
+};
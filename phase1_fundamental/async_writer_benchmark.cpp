@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_harness.h"
+#include "file_writer.h"
+
+// Caller-side latency of writing log records to a file: each record's
+// write call is timed on its own, so the tail shows the calls that paid
+// for a flush. Compared: fprintf and fwrite on a FILE* (flushing in the
+// caller whenever stdio's buffer fills), fwrite with an fdatasync every
+// 256 KiB (the synchronous way to get the same durability as
+// Sync::EveryBuffer), and AsyncFileWriter on each backend and sync policy.
+class AsyncWriterBenchmark {
+public:
+    enum class Variant { Fprintf, Fwrite, FwriteSync, Async };
+
+    struct Config {
+        const char* name;
+        Variant variant;
+        AsyncFileWriter::Backend backend;
+        AsyncFileWriter::Sync sync;
+    };
+
+    struct Row {
+        std::string name;
+        double total_ms;
+        double p50, p99, p999, max;
+        size_t stalls;
+    };
+
+    static std::vector<Row> rows;
+
+    static constexpr size_t SYNC_BYTES = 256 * 1024;
+
+    static int formatRecord(char* buffer, size_t size, long i) {
+        return std::snprintf(buffer, size, "record %ld frame %ld value %ld status ok\n", i, i % 64, i * 10);
+    }
+
+    static double percentile(std::vector<int64_t>& sorted, double p) {
+        return static_cast<double>(sorted[static_cast<size_t>(p * (sorted.size() - 1))]);
+    }
+
+    // Writes `records` records, filling latencies (ns per call). Returns
+    // the async writer's stall count (0 for stdio).
+    static size_t writeRecords(const Config& config, const std::string& path, long records,
+                               std::vector<int64_t>& latencies) {
+        using Clock = std::chrono::steady_clock;
+        latencies.clear();
+        latencies.reserve(records);
+        char record[128];
+        size_t stalls = 0;
+        if (config.variant == Variant::Async) {
+            AsyncFileWriter::Options options;
+            options.backend = config.backend;
+            options.sync = config.sync;
+            AsyncFileWriter writer(path, options);
+            for (long i = 0; i < records; ++i) {
+                int length = formatRecord(record, sizeof(record), i);
+                auto start = Clock::now();
+                writer.write(record, length);
+                latencies.push_back((Clock::now() - start).count());
+            }
+            stalls = writer.stalls();
+            writer.close();
+            return stalls;
+        }
+        FileHandle file(path.c_str(), "w");
+        if (!file) {
+            std::perror(path.c_str());
+            std::exit(1);
+        }
+        size_t unsynced = 0;
+        for (long i = 0; i < records; ++i) {
+            auto start = Clock::now();
+            if (config.variant == Variant::Fprintf) {
+                std::fprintf(file.get(), "record %ld frame %ld value %ld status ok\n", i, i % 64, i * 10);
+            } else {
+                int length = formatRecord(record, sizeof(record), i);
+                std::fwrite(record, 1, length, file.get());
+                unsynced += length;
+                if (config.variant == Variant::FwriteSync && unsynced >= SYNC_BYTES) {
+                    std::fflush(file.get());
+                    fdatasync(fileno(file.get()));
+                    unsynced = 0;
+                }
+            }
+            latencies.push_back((Clock::now() - start).count());
+        }
+        if (config.variant == Variant::FwriteSync) {
+            std::fflush(file.get());
+            fdatasync(fileno(file.get()));
+        }
+        return stalls;
+    }
+
+    static void measure(bench::Suite& suite, const Config& config, const std::string& path, long records) {
+        std::vector<int64_t> latencies;
+        size_t stalls = 0;
+        auto result = suite.run_once(config.name, [&] {
+            stalls = writeRecords(config, path, records, latencies);
+        }, records);
+        std::sort(latencies.begin(), latencies.end());
+        rows.push_back(Row{config.name, result.median * records / 1e6, percentile(latencies, 0.5),
+                           percentile(latencies, 0.99), percentile(latencies, 0.999),
+                           static_cast<double>(latencies.back()), stalls});
+    }
+};
+
+std::vector<AsyncWriterBenchmark::Row> AsyncWriterBenchmark::rows;
+
+int main(int argc, char** argv) {
+    long records = 1000000;
+    std::string path = "/tmp/async_writer_benchmark.log";
+    if (argc > 1 && argv[1][0] != '-') {
+        records = std::atol(argv[1]);
+    }
+    if (argc > 2 && argv[2][0] != '-') {
+        path = argv[2];
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 3;
+    bench::Suite suite("async_writer_benchmark", argc, argv, options);
+
+    using B = AsyncFileWriter::Backend;
+    using S = AsyncFileWriter::Sync;
+    using V = AsyncWriterBenchmark::Variant;
+    const AsyncWriterBenchmark::Config configs[] = {
+        {"fprintf", V::Fprintf, B::Auto, S::Never},
+        {"fwrite", V::Fwrite, B::Auto, S::Never},
+        {"fwrite + fdatasync/256K", V::FwriteSync, B::Auto, S::Never},
+        {"async pwrite", V::Async, B::Pwrite, S::Never},
+        {"async io_uring", V::Async, B::IoUring, S::Never},
+        {"async pwrite, sync/buffer", V::Async, B::Pwrite, S::EveryBuffer},
+        {"async io_uring, sync/buffer", V::Async, B::IoUring, S::EveryBuffer},
+    };
+    {
+        AsyncFileWriter probe(path);
+        if (probe.backend() != B::IoUring) {
+            std::printf("io_uring unavailable; the io_uring rows fall back to pwrite\n");
+        }
+    }
+    for (const auto& config : configs) {
+        AsyncWriterBenchmark::measure(suite, config, path, records);
+    }
+
+    std::printf("\n%ld records to %s, caller-side ns per write call\n", records, path.c_str());
+    std::printf("%-30s %10s %8s %8s %8s %10s %8s\n", "writer", "total ms", "p50", "p99", "p99.9", "max",
+                "stalls");
+    for (const auto& row : AsyncWriterBenchmark::rows) {
+        std::printf("%-30s %10.1f %8.0f %8.0f %8.0f %10.0f %8zu\n", row.name.c_str(), row.total_ms, row.p50,
+                    row.p99, row.p999, row.max, row.stalls);
+    }
+    std::remove(path.c_str());
+    return 0;
+}
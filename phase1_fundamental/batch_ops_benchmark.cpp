@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "batch_ops.h"
+#include "bench_harness.h"
+
+// Resource::substract from safe_memory_management.cpp.
+static int substract(int a, int b) { return a - b; }
+
+using Operation = int (*)(int, int);
+
+class DispatchBenchmark {
+public:
+    struct Row {
+        std::string design;
+        double ns[2];       // per pair: small (L1) and large spans
+    };
+
+    static std::vector<Row> rows;
+
+    // The calculateAndPrint pattern: one indirect call per pair. The
+    // pointer goes through a volatile so the compiler can't see which
+    // function it is.
+    static void perPairPointer(Operation target, const int* a, const int* b, int* out, size_t size) {
+        Operation volatile opaque = target;
+        Operation op = opaque;
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = op(a[i], b[i]);
+        }
+    }
+
+    static void perPairFunction(const std::function<int(int, int)>& op, const int* a, const int* b, int* out,
+                                size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = op(a[i], b[i]);
+        }
+    }
+
+    static void compare(bench::Suite& suite, size_t size, int column) {
+        std::vector<int> a(size);
+        std::vector<int> b(size);
+        std::vector<int> out(size);
+        std::mt19937 rng(3);
+        for (size_t i = 0; i < size; ++i) {
+            a[i] = static_cast<int>(rng() % 100000);
+            b[i] = static_cast<int>(rng() % 100000);
+        }
+        const std::string suffix = " n=" + std::to_string(size);
+        std::function<int(int, int)> wrapped = substract;
+        batch::DynamicOp dynamic(batch::Subtract{});
+
+        auto record = [&](const std::string& design, auto body) {
+            auto result = suite.run(design + suffix, [&] {
+                body();
+                bench::ClobberMemory();
+            }, size);
+            for (Row& row : rows) {
+                if (row.design == design) {
+                    row.ns[column] = result.median;
+                    return;
+                }
+            }
+            Row row{design, {0, 0}};
+            row.ns[column] = result.median;
+            rows.push_back(row);
+        };
+
+        record("function pointer", [&] { perPairPointer(substract, a.data(), b.data(), out.data(), size); });
+        record("std::function", [&] { perPairFunction(wrapped, a.data(), b.data(), out.data(), size); });
+        record("DynamicOp (erased batch)", [&] { dynamic(a.data(), b.data(), out.data(), size); });
+        record("template Function<substract>", [&] {
+            batch::apply(a.data(), b.data(), out.data(), size, batch::Function<substract>());
+        });
+        record("template Subtract, scalar", [&] {
+            batch::apply(a.data(), b.data(), out.data(), size, batch::Subtract(), simd::Isa::Scalar);
+        });
+        record("SIMD batch sse2", [&] {
+            batch::apply(a.data(), b.data(), out.data(), size, batch::Subtract(), simd::Isa::SSE2);
+        });
+        if (simd::usable(simd::Isa::AVX2) == simd::Isa::AVX2) {
+            record("SIMD batch avx2", [&] {
+                batch::apply(a.data(), b.data(), out.data(), size, batch::Subtract(), simd::Isa::AVX2);
+            });
+        }
+
+        // Every path must agree.
+        std::vector<int> expected(size);
+        perPairPointer(substract, a.data(), b.data(), expected.data(), size);
+        batch::apply(a.data(), b.data(), out.data(), size, batch::Subtract());
+        if (out != expected) {
+            std::cout << "MISMATCH between function pointer and SIMD batch results\n";
+        }
+    }
+};
+
+std::vector<DispatchBenchmark::Row> DispatchBenchmark::rows;
+
+int main(int argc, char** argv) {
+    size_t large = 1 << 24;
+    if (argc > 1 && argv[1][0] != '-') {
+        large = std::strtoul(argv[1], nullptr, 10);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 9;
+    bench::Suite suite("batch_ops_benchmark", argc, argv, options);
+
+    const size_t small = 2048;      // 3 x 8 KiB: stays in L1
+    DispatchBenchmark::compare(suite, small, 0);
+    DispatchBenchmark::compare(suite, large, 1);
+
+    std::printf("\n%-30s %12s %12s\n", "ns per pair (median)", ("n=" + std::to_string(small)).c_str(),
+                ("n=" + std::to_string(large)).c_str());
+    for (const auto& row : DispatchBenchmark::rows) {
+        std::printf("%-30s %12.3f %12.3f\n", row.design.c_str(), row.ns[0], row.ns[1]);
+    }
+    return 0;
+}
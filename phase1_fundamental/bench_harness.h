@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "memory_telemetry.h"
+
+// Small micro-benchmark harness.
+//
+// Each benchmark body is one call. The harness first calibrates how many
+// calls fit in min_sample_ms, runs a few warmup samples, then records
+// `samples` timed samples and reports nanoseconds per operation as min,
+// median, mean, p99 and standard deviation. Results can also be written as
+// JSON or CSV (--json=FILE, --csv=FILE) so runs can be diffed. Built with
+// -DMEMORY_TELEMETRY, each benchmark is a begin/end marker pair on the
+// memory timeline.
+namespace bench {
+
+// Forces `value` to be materialized, so the computation that produced it
+// can't be deleted as dead code.
+template<typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template<typename T>
+inline void DoNotOptimize(T& value) {
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+// Forces all pending writes to memory to be treated as observable.
+inline void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+struct Options {
+    int warmup_samples = 3;
+    int samples = 25;
+    double min_sample_ms = 5.0;
+};
+
+struct Result {
+    std::string name;
+    size_t calls_per_sample = 0;
+    size_t ops_per_call = 1;
+    // Nanoseconds per operation across samples.
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double p99 = 0;
+    double stddev = 0;
+
+    double ops_per_second() const { return median > 0 ? 1e9 / median : 0; }
+};
+
+class Suite {
+private:
+    std::string suite_name;
+    Options options;
+    std::vector<Result> results;
+    std::string json_path;
+    std::string csv_path;
+    bool quiet = false;
+
+    template<typename Body>
+    static double time_calls(Body& body, size_t calls) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            body();
+            ClobberMemory();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    // Grow the call count until one sample takes at least min_sample_ms.
+    // Every step re-measures, so a cold first call (page faults, first
+    // chunk allocation) can't lock in a too-small count.
+    template<typename Body>
+    size_t calibrate(Body& body) const {
+        size_t calls = 1;
+        const double target_ns = options.min_sample_ms * 1e6;
+        while (true) {
+            double elapsed = time_calls(body, calls);
+            if (elapsed >= target_ns || calls >= (size_t(1) << 40)) {
+                return calls;
+            }
+            size_t next = calls * 2;
+            if (elapsed > target_ns / 100) {
+                // Close enough to extrapolate; aim a little past the target.
+                double scale = std::min(target_ns / elapsed * 1.2, 100.0);
+                next = std::max(next / 2 + 1, static_cast<size_t>(calls * scale));
+            }
+            calls = next;
+        }
+    }
+
+    static double percentile(const std::vector<double>& sorted, double p) {
+        double rank = p * (sorted.size() - 1);
+        size_t low = static_cast<size_t>(rank);
+        size_t high = std::min(low + 1, sorted.size() - 1);
+        return sorted[low] + (sorted[high] - sorted[low]) * (rank - low);
+    }
+
+    static std::string json_escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    static Result summarize(const std::string& name, std::vector<double>& per_op,
+                            size_t calls, size_t ops_per_call) {
+        std::sort(per_op.begin(), per_op.end());
+
+        Result r;
+        r.name = name;
+        r.calls_per_sample = calls;
+        r.ops_per_call = ops_per_call;
+        r.min = per_op.front();
+        r.median = percentile(per_op, 0.5);
+        r.p99 = percentile(per_op, 0.99);
+        double sum = 0;
+        for (double v : per_op) {
+            sum += v;
+        }
+        r.mean = sum / per_op.size();
+        double squares = 0;
+        for (double v : per_op) {
+            squares += (v - r.mean) * (v - r.mean);
+        }
+        r.stddev = per_op.size() > 1 ? std::sqrt(squares / (per_op.size() - 1)) : 0;
+        return r;
+    }
+
+    void print(const Result& r) const {
+        std::cout << "  " << std::left << std::setw(48) << r.name << std::right
+                  << std::fixed << std::setprecision(2)
+                  << " median " << std::setw(10) << r.median << " ns"
+                  << "  min " << std::setw(10) << r.min
+                  << "  p99 " << std::setw(10) << r.p99
+                  << "  sd " << std::setw(8) << r.stddev
+                  << "  (" << r.calls_per_sample << " calls/sample)\n";
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+
+public:
+    Suite(std::string name, int argc = 0, char** argv = nullptr, Options opts = Options())
+        : suite_name(std::move(name)), options(opts) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--json=", 0) == 0) {
+                json_path = arg.substr(7);
+            } else if (arg.rfind("--csv=", 0) == 0) {
+                csv_path = arg.substr(6);
+            } else if (arg.rfind("--samples=", 0) == 0) {
+                options.samples = std::max(1, std::atoi(arg.c_str() + 10));
+            } else if (arg.rfind("--min-ms=", 0) == 0) {
+                options.min_sample_ms = std::atof(arg.c_str() + 9);
+            } else if (arg == "--quiet") {
+                quiet = true;
+            }
+        }
+    }
+
+    ~Suite() {
+        if (!json_path.empty()) {
+            std::ofstream out(json_path);
+            write_json(out);
+        }
+        if (!csv_path.empty()) {
+            std::ofstream out(csv_path);
+            write_csv(out);
+        }
+    }
+
+    Suite(const Suite&) = delete;
+    Suite& operator=(const Suite&) = delete;
+
+    // Times `body`; each call counts as `ops_per_call` operations.
+    template<typename Body>
+    Result run(const std::string& name, Body body, size_t ops_per_call = 1) {
+        memory_telemetry::Marker marker(name);
+        size_t calls = calibrate(body);
+        for (int i = 0; i < options.warmup_samples; ++i) {
+            time_calls(body, calls);
+        }
+
+        std::vector<double> per_op;
+        per_op.reserve(options.samples);
+        double ops = static_cast<double>(calls) * ops_per_call;
+        for (int i = 0; i < options.samples; ++i) {
+            per_op.push_back(time_calls(body, calls) / ops);
+        }
+        return record(summarize(name, per_op, calls, ops_per_call));
+    }
+
+    // Records a result measured elsewhere (e.g. a multi-threaded run that
+    // can't be expressed as a single-call body).
+    Result record(const Result& r) {
+        results.push_back(r);
+        if (!quiet) {
+            print(r);
+        }
+        return r;
+    }
+
+    // For bodies too slow or too stateful to repeat in a loop (thread
+    // spawning, whole-container workloads): one call per sample and no
+    // calibration.
+    template<typename Body>
+    Result run_once(const std::string& name, Body body, size_t ops_per_call) {
+        memory_telemetry::Marker marker(name);
+        for (int i = 0; i < options.warmup_samples; ++i) {
+            time_calls(body, 1);
+        }
+        std::vector<double> per_op;
+        per_op.reserve(options.samples);
+        for (int i = 0; i < options.samples; ++i) {
+            per_op.push_back(time_calls(body, 1) / ops_per_call);
+        }
+        return record(summarize(name, per_op, 1, ops_per_call));
+    }
+
+    const std::vector<Result>& all() const { return results; }
+    const Options& settings() const { return options; }
+
+    void write_json(std::ostream& out) const {
+        out << "{\"suite\": \"" << json_escape(suite_name) << "\", \"unit\": \"ns/op\", \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << (i ? ",\n  " : "\n  ")
+                << "{\"name\": \"" << json_escape(r.name) << "\""
+                << ", \"calls_per_sample\": " << r.calls_per_sample
+                << ", \"ops_per_call\": " << r.ops_per_call
+                << ", \"min\": " << r.min
+                << ", \"median\": " << r.median
+                << ", \"mean\": " << r.mean
+                << ", \"p99\": " << r.p99
+                << ", \"stddev\": " << r.stddev << "}";
+        }
+        out << "\n]}\n";
+    }
+
+    void write_csv(std::ostream& out) const {
+        out << "suite,name,calls_per_sample,ops_per_call,min_ns,median_ns,mean_ns,p99_ns,stddev_ns\n";
+        for (const Result& r : results) {
+            out << suite_name << ",\"" << r.name << "\"," << r.calls_per_sample << ","
+                << r.ops_per_call << "," << r.min << "," << r.median << "," << r.mean << ","
+                << r.p99 << "," << r.stddev << "\n";
+        }
+    }
+};
+
+} // namespace bench
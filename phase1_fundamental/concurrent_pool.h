@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "simple_pool.h"
+
+namespace detail {
+
+// Guards the link between pools and the per-thread caches that point at
+// them. Only taken when a thread first touches a pool, when a thread exits
+// and when a pool is destroyed.
+inline std::mutex& pool_registry_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Pool ids are never reused, so a thread can't mistake a new pool for an
+// old one that happened to live at the same address.
+inline std::atomic<uint64_t> next_pool_id{1};
+
+} // namespace detail
+
+// Thread-safe pool with a per-thread caching front-end.
+//
+// Each thread allocates from and frees into its own cache with no atomics.
+// When a cache runs dry it takes a whole batch of BATCH_SIZE slots from a
+// shared lock-free depot; when it holds two batches' worth it hands one
+// back. Only when the depot is empty does a thread take the backend mutex
+// to carve a fresh batch out of the underlying SimplePool.
+//
+// A slot may be freed by any thread: it simply joins that thread's cache.
+template<typename T>
+class ConcurrentPool {
+private:
+    // A free slot. `next` chains slots inside a batch, `next_batch` chains
+    // batches inside the depot (only meaningful on a batch's first slot).
+    // `next_batch` is atomic because a popper may read it from a stale top
+    // while the owner of that slot is pushing it again.
+    union Slot {
+        struct {
+            Slot* next;
+            std::atomic<Slot*> next_batch;
+        } link;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct ThreadCache {
+        Slot* head = nullptr;
+        size_t count = 0;
+        ConcurrentPool* owner = nullptr;   // cleared when the pool dies
+    };
+
+    // Owns this thread's caches for every pool it has touched. On thread
+    // exit any slots still cached go back to their pool, and the pool
+    // forgets the cache, so recycled threads don't pile up entries.
+    struct ThreadCaches {
+        std::vector<std::pair<uint64_t, std::shared_ptr<ThreadCache>>> entries;
+
+        ~ThreadCaches() {
+            std::lock_guard<std::mutex> lock(detail::pool_registry_mutex());
+            for (auto& entry : entries) {
+                ThreadCache& cache = *entry.second;
+                if (cache.owner) {
+                    cache.owner->return_to_backend(cache);
+                }
+            }
+        }
+    };
+
+    static constexpr size_t BATCH_SIZE = 64;
+
+    // The depot is a Treiber stack of batches. The top 16 bits of the head
+    // word carry a version tag so a pop can't succeed on a recycled pointer
+    // (ABA). Slots are never unmapped while the pool lives, so reading
+    // `next_batch` of a stale top is harmless; the CAS just fails.
+    static constexpr int TAG_SHIFT = 48;
+    static constexpr uint64_t PTR_MASK = (uint64_t(1) << TAG_SHIFT) - 1;
+    static_assert(sizeof(void*) == 8, "tagged depot pointer needs 64-bit pointers");
+
+    std::atomic<uint64_t> depot{0};
+
+    std::mutex backend_mutex;
+    SimplePool<Slot> backend;
+
+    const uint64_t id = detail::next_pool_id.fetch_add(1, std::memory_order_relaxed);
+    std::vector<std::shared_ptr<ThreadCache>> caches;   // guarded by the registry mutex
+
+    static Slot* unpack(uint64_t word) {
+        return reinterpret_cast<Slot*>(word & PTR_MASK);
+    }
+
+    static uint64_t pack(Slot* slot, uint64_t old_word) {
+        uint64_t tag = (old_word >> TAG_SHIFT) + 1;
+        return reinterpret_cast<uint64_t>(slot) | (tag << TAG_SHIFT);
+    }
+
+    void push_batch(Slot* batch) {
+        uint64_t old_word = depot.load(std::memory_order_relaxed);
+        do {
+            batch->link.next_batch.store(unpack(old_word), std::memory_order_relaxed);
+        } while (!depot.compare_exchange_weak(old_word, pack(batch, old_word),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+
+    Slot* pop_batch() {
+        uint64_t old_word = depot.load(std::memory_order_acquire);
+        while (Slot* top = unpack(old_word)) {
+            Slot* next = top->link.next_batch.load(std::memory_order_relaxed);
+            if (depot.compare_exchange_weak(old_word, pack(next, old_word),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                return top;
+            }
+        }
+        return nullptr;
+    }
+
+    // Slow path: carve a new batch under the backend mutex.
+    Slot* carve_batch() {
+        std::lock_guard<std::mutex> lock(backend_mutex);
+        Slot* head = nullptr;
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            Slot* slot = backend.allocate();
+            slot->link.next = head;
+            head = slot;
+        }
+        return head;
+    }
+
+    void refill(ThreadCache& cache) {
+        Slot* batch = pop_batch();
+        cache.head = batch ? batch : carve_batch();
+        cache.count = BATCH_SIZE;
+    }
+
+    // Split BATCH_SIZE slots off the cache and publish them to the depot.
+    void spill(ThreadCache& cache) {
+        Slot* batch = cache.head;
+        Slot* tail = batch;
+        for (size_t i = 1; i < BATCH_SIZE; ++i) {
+            tail = tail->link.next;
+        }
+        cache.head = tail->link.next;
+        cache.count -= BATCH_SIZE;
+        tail->link.next = nullptr;
+        push_batch(batch);
+    }
+
+    // Called on thread exit with the registry mutex held. Also drops the
+    // cache from `caches`.
+    void return_to_backend(ThreadCache& cache) {
+        {
+            std::lock_guard<std::mutex> lock(backend_mutex);
+            while (cache.head) {
+                Slot* next = cache.head->link.next;
+                backend.deallocate(cache.head);
+                cache.head = next;
+            }
+        }
+        cache.count = 0;
+        cache.owner = nullptr;
+        for (size_t i = 0; i < caches.size(); ++i) {
+            if (caches[i].get() == &cache) {
+                caches[i] = std::move(caches.back());
+                caches.pop_back();
+                break;
+            }
+        }
+    }
+
+    ThreadCache& local_cache() {
+        thread_local uint64_t last_id = 0;
+        thread_local ThreadCache* last_cache = nullptr;
+        if (last_id == id) {
+            return *last_cache;
+        }
+        return find_local_cache(last_id, last_cache);
+    }
+
+    ThreadCache& find_local_cache(uint64_t& last_id, ThreadCache*& last_cache) {
+        thread_local ThreadCaches local;
+
+        std::lock_guard<std::mutex> lock(detail::pool_registry_mutex());
+        ThreadCache* found = nullptr;
+        for (auto it = local.entries.begin(); it != local.entries.end();) {
+            if (it->first == id) {
+                found = it->second.get();
+            } else if (!it->second->owner) {
+                // That pool is gone; drop its cache.
+                it = local.entries.erase(it);
+                continue;
+            }
+            ++it;
+        }
+        if (!found) {
+            auto cache = std::make_shared<ThreadCache>();
+            cache->owner = this;
+            caches.push_back(cache);
+            local.entries.emplace_back(id, cache);
+            found = cache.get();
+        }
+        last_id = id;
+        last_cache = found;
+        return *found;
+    }
+
+public:
+    ConcurrentPool() = default;
+
+    ~ConcurrentPool() {
+        // Slots cached by threads that are still running belong to the
+        // backend we are about to free; forget them.
+        std::lock_guard<std::mutex> lock(detail::pool_registry_mutex());
+        for (auto& cache : caches) {
+            cache->owner = nullptr;
+            cache->head = nullptr;
+            cache->count = 0;
+        }
+    }
+
+    ConcurrentPool(const ConcurrentPool&) = delete;
+    ConcurrentPool& operator=(const ConcurrentPool&) = delete;
+
+    T* allocate() {
+        ThreadCache& cache = local_cache();
+        if (!cache.head) {
+            refill(cache);
+        }
+        Slot* slot = cache.head;
+        cache.head = slot->link.next;
+        --cache.count;
+        return reinterpret_cast<T*>(slot->storage);
+    }
+
+    void deallocate(T* ptr) {
+        ThreadCache& cache = local_cache();
+        Slot* slot = reinterpret_cast<Slot*>(ptr);
+        slot->link.next = cache.head;
+        cache.head = slot;
+        if (++cache.count >= 2 * BATCH_SIZE) {
+            spill(cache);
+        }
+    }
+
+    // Threads that currently hold a cache for this pool.
+    size_t thread_caches() const {
+        std::lock_guard<std::mutex> lock(detail::pool_registry_mutex());
+        return caches.size();
+    }
+
+    // Slots carved from the backend so far, whether live or cached.
+    size_t capacity() {
+        std::lock_guard<std::mutex> lock(backend_mutex);
+        return backend.live_count();
+    }
+};
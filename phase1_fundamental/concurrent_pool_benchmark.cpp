@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "concurrent_pool.h"
+
+struct Message {
+    long id;
+    char payload[56];
+};
+
+class ScalingBenchmark {
+public:
+    static constexpr int BATCH = 256;
+
+    // Every thread repeatedly allocates BATCH objects, writes them and
+    // frees them. One call is one full run including thread start-up.
+    template<typename Alloc, typename Free>
+    static void run(int threads, int rounds, Alloc alloc, Free release) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                Message* held[BATCH];
+                for (int r = 0; r < rounds; ++r) {
+                    for (int i = 0; i < BATCH; ++i) {
+                        held[i] = alloc();
+                        held[i]->id = t;
+                    }
+                    bench::DoNotOptimize(held);
+                    for (int i = 0; i < BATCH; ++i) {
+                        release(held[i]);
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Thread t allocates, then thread (t + 1) % n frees what t allocated.
+    static void crossThreadFree(int threads, int per_thread) {
+        ConcurrentPool<Message> pool;
+        std::vector<std::vector<Message*>> produced(threads);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    Message* m = pool.allocate();
+                    m->id = t * per_thread + i;
+                    produced[t].push_back(m);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+
+        long expected = 0;
+        for (long i = 0; i < static_cast<long>(threads) * per_thread; ++i) {
+            expected += i;
+        }
+        std::vector<long> sums(threads, 0);
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                for (Message* m : produced[(t + 1) % threads]) {
+                    sums[t] += m->id;
+                    pool.deallocate(m);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        long total = 0;
+        for (long s : sums) {
+            total += s;
+        }
+        std::cout << "Cross-thread free (" << threads << " threads, " << per_thread
+                  << " each): " << (total == expected ? "OK" : "MISMATCH")
+                  << ", slots carved: " << pool.capacity() << "\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    int max_threads = static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+    if (argc > 1 && argv[1][0] != '-') {
+        max_threads = std::atoi(argv[1]);
+    }
+    const int rounds = 2000;
+    bench::Suite suite("concurrent_pool_benchmark", argc, argv);
+
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << "(ns per allocation, aggregate over all threads)\n";
+
+    std::vector<std::string> summary;
+    double single = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        const size_t ops = static_cast<size_t>(threads) * rounds * ScalingBenchmark::BATCH;
+        const std::string suffix = " threads=" + std::to_string(threads);
+
+        ConcurrentPool<Message> pool;
+        auto pool_result = suite.run_once("ConcurrentPool" + suffix, [&] {
+            ScalingBenchmark::run(threads, rounds,
+                [&] { return pool.allocate(); },
+                [&](Message* m) { pool.deallocate(m); });
+        }, ops);
+        auto malloc_result = suite.run_once("malloc" + suffix, [&] {
+            ScalingBenchmark::run(threads, rounds,
+                [] { return static_cast<Message*>(std::malloc(sizeof(Message))); },
+                [](Message* m) { std::free(m); });
+        }, ops);
+
+        if (threads == 1) {
+            single = pool_result.ops_per_second();
+        }
+        summary.push_back(std::to_string(threads) + "\t " +
+                          std::to_string(pool_result.ops_per_second() / 1e6) + "\t  " +
+                          std::to_string(malloc_result.ops_per_second() / 1e6) + "\t" +
+                          std::to_string(pool_result.ops_per_second() / single) + "x");
+    }
+
+    std::cout << "\nthreads  pool M/s\tmalloc M/s\tpool speedup vs 1 thread\n";
+    for (const auto& line : summary) {
+        std::cout << line << "\n";
+    }
+
+    ScalingBenchmark::crossThreadFree(std::max(2, max_threads), 100000);
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "pool_allocator.h"
+
+class ContainerBenchmark {
+public:
+    // One call: push_back n ints, erase every other one, push_front n/2,
+    // clear. The container (and its resource) outlive the calls, so pools
+    // are warm after the first one.
+    template<typename List>
+    static void listRound(List& list, int n) {
+        for (int i = 0; i < n; ++i) {
+            list.push_back(i);
+        }
+        for (auto it = list.begin(); it != list.end();) {
+            it = list.erase(it);
+            if (it != list.end()) {
+                ++it;
+            }
+        }
+        for (int i = 0; i < n / 2; ++i) {
+            list.push_front(i);
+        }
+        bench::DoNotOptimize(list.size());
+        list.clear();
+    }
+
+    // One call: insert n random keys, erase them in a different random order.
+    template<typename Map>
+    static void mapRound(Map& map, const std::vector<int>& keys,
+                         const std::vector<int>& erase_order) {
+        for (int key : keys) {
+            map.emplace(key, key);
+        }
+        bench::DoNotOptimize(map.size());
+        for (int key : erase_order) {
+            map.erase(key);
+        }
+    }
+
+    static void report(const std::string& name, const bench::Result& r, const bench::Result& baseline) {
+        std::cout << "  " << name << baseline.median / r.median << "x vs std::allocator\n";
+    }
+
+    static void compareLists(bench::Suite& suite, int n) {
+        std::cout << "\nstd::list<int>: " << n << " nodes per round (ns per node)\n";
+        const std::string suffix = " list n=" + std::to_string(n);
+
+        std::list<int> default_list;
+        auto default_result = suite.run("std::allocator" + suffix,
+            [&] { listRound(default_list, n); }, n);
+
+        std::pmr::unsynchronized_pool_resource sync_resource;
+        std::pmr::list<int> sync_list(&sync_resource);
+        auto sync_result = suite.run("pmr::unsynchronized_pool_resource" + suffix,
+            [&] { listRound(sync_list, n); }, n);
+
+        PoolResource pmr_resource;
+        std::pmr::list<int> pmr_list(&pmr_resource);
+        auto pmr_result = suite.run("pmr + PoolResource" + suffix,
+            [&] { listRound(pmr_list, n); }, n);
+
+        PoolResource alloc_resource;
+        std::list<int, PoolAllocator<int>> alloc_list{PoolAllocator<int>(alloc_resource)};
+        auto alloc_result = suite.run("PoolAllocator" + suffix,
+            [&] { listRound(alloc_list, n); }, n);
+
+        report("pmr::unsynchronized_pool_resource: ", sync_result, default_result);
+        report("pmr + PoolResource:                ", pmr_result, default_result);
+        report("PoolAllocator:                     ", alloc_result, default_result);
+    }
+
+    static void compareMaps(bench::Suite& suite, int n) {
+        std::cout << "\nstd::map<int,int>: " << n << " keys per round (ns per key)\n";
+        const std::string suffix = " map n=" + std::to_string(n);
+        std::mt19937 rng(42);
+        std::vector<int> keys(n);
+        for (int i = 0; i < n; ++i) {
+            keys[i] = static_cast<int>(rng());
+        }
+        std::vector<int> erase_order = keys;
+        std::shuffle(erase_order.begin(), erase_order.end(), rng);
+
+        std::map<int, int> default_map;
+        auto default_result = suite.run("std::allocator" + suffix,
+            [&] { mapRound(default_map, keys, erase_order); }, n);
+
+        std::pmr::unsynchronized_pool_resource sync_resource;
+        std::pmr::map<int, int> sync_map(&sync_resource);
+        auto sync_result = suite.run("pmr::unsynchronized_pool_resource" + suffix,
+            [&] { mapRound(sync_map, keys, erase_order); }, n);
+
+        PoolResource pmr_resource;
+        std::pmr::map<int, int> pmr_map(&pmr_resource);
+        auto pmr_result = suite.run("pmr + PoolResource" + suffix,
+            [&] { mapRound(pmr_map, keys, erase_order); }, n);
+
+        PoolResource alloc_resource;
+        using Alloc = PoolAllocator<std::pair<const int, int>>;
+        std::map<int, int, std::less<int>, Alloc> alloc_map{Alloc(alloc_resource)};
+        auto alloc_result = suite.run("PoolAllocator" + suffix,
+            [&] { mapRound(alloc_map, keys, erase_order); }, n);
+
+        report("pmr::unsynchronized_pool_resource: ", sync_result, default_result);
+        report("pmr + PoolResource:                ", pmr_result, default_result);
+        report("PoolAllocator:                     ", alloc_result, default_result);
+    }
+
+    // Control block and object share one pooled allocation.
+    static void demonstrateAllocateShared() {
+        PoolResource resource;
+        {
+            auto value = std::allocate_shared<long>(PoolAllocator<long>(resource), 7);
+            auto copy = value;
+            std::cout << "\nallocate_shared value: " << *copy
+                      << ", use_count: " << copy.use_count()
+                      << ", pool footprint: " << resource.footprint_bytes() << " bytes\n";
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    bench::Suite suite("container_benchmark", argc, argv);
+    ContainerBenchmark::compareLists(suite, 1000);
+    ContainerBenchmark::compareLists(suite, 100000);
+    ContainerBenchmark::compareMaps(suite, 1000);
+    ContainerBenchmark::compareMaps(suite, 100000);
+    ContainerBenchmark::demonstrateAllocateShared();
+    return 0;
+}
@@ -2,6 +2,10 @@
 #include <vector>
 #include <string>
 
+#include "layout_inspector.h"
+#include "output_sink.h"
+#include "stack_executor.h"
+
 class EnhancedMemoryDemo {
 private:
     static int static_var;
@@ -64,6 +68,12 @@ public:
                      (char*)&member2 - (char*)&member1 << " bytes\n";
         std::cout << "Distance heap1->heap2: " << 
                      (char*)heap2 - (char*)heap1 << " bytes\n";
+
+        std::cout << "\n6. OBJECT LAYOUT:\n";
+        LAYOUT_OF(EnhancedMemoryDemo,
+                  LAYOUT_FIELD(EnhancedMemoryDemo, member1),
+                  LAYOUT_FIELD(EnhancedMemoryDemo, member2),
+                  LAYOUT_FIELD(EnhancedMemoryDemo, member_array)).print(std::cout);
         
         // Cleanup
         delete heap1;
@@ -75,14 +85,19 @@ public:
 
 int EnhancedMemoryDemo::static_var = 42;
 
-// Function to demonstrate stack frame behavior
-void demonstrateStackFrames(int depth) {
+// Function to demonstrate stack frame behavior. Lines collect in `out`
+// and are written when the caller flushes it. Stops early rather than
+// recurse into the last STACK_MARGIN bytes of the stack
+const size_t STACK_MARGIN = 16 * 1024;
+
+void demonstrateStackFrames(OutputSink& out, int depth) {
     int frame_var = depth * 10;
-    std::cout << "Frame " << depth << " variable at: " << &frame_var 
-              << " (value: " << frame_var << ")\n";
+    size_t stack_left = StackExecutor::remaining();
+    out << "Frame " << depth << " variable at: " << &frame_var
+        << " (value: " << frame_var << ", " << stack_left / 1024 << " KiB of stack left)\n";
     
-    if (depth > 0) {
-        demonstrateStackFrames(depth - 1);
+    if (depth > 0 && stack_left > STACK_MARGIN) {
+        demonstrateStackFrames(out, depth - 1);
     }
 }
 
@@ -116,8 +131,19 @@ int main() {
     
     // Test 3: Stack frame demonstration
     std::cout << "\n" << std::string(50, '=') << "\n";
-    std::cout << "TEST 3: Stack Frame Growth\n";
-    demonstrateStackFrames(5);
+    std::cout << "TEST 3: Stack Frame Growth\n" << std::flush;
+    OutputSink& out = OutputSink::standard();
+    demonstrateStackFrames(out, 5);
+    out.flush();    // before printf below writes to the same stdout
+
+    // Test 4: The same frames on a small stack of known size
+    std::cout << "\n" << std::string(50, '=') << "\n";
+    std::cout << "TEST 4: Stack High-Water Mark\n" << std::flush;
+    StackExecutor executor(64 * 1024);
+    executor.run([&out] { demonstrateStackFrames(out, 5); });
+    out.flush();
+    std::cout << "64 KiB executor stack: deepest frame used " << executor.usage().used
+              << " bytes, " << executor.usage().remaining() << " never touched\n\n";
 
     test_stack_order();
     
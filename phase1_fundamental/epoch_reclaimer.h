@@ -0,0 +1,247 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for lock-free data structures.
+//
+// A reader pins the current global epoch for the duration of an operation
+// (EpochReclaimer::Guard). A writer that unlinks a node retires it instead
+// of deleting it: the node goes into the writer's bag for the epoch it was
+// retired in. The global epoch only advances when every pinned thread has
+// seen the current one, so once it has moved two steps past a bag's epoch
+// no reader can still hold a pointer into that bag and it is freed.
+//
+// Readers pay one store on entry and one on exit; there are no per-node
+// hazard pointers or refcounts. The catch is that a reader that stays
+// pinned holds back all reclamation, so keep guards short.
+//
+// One process-wide domain. Thread records are reused by later threads but
+// never freed (a thread may retire from thread_local destructors), and a
+// thread's unreclaimed bags are handed to the domain when it exits.
+class EpochReclaimer {
+private:
+    struct Retired {
+        void* ptr;
+        void (*destroy)(void*);
+    };
+
+    struct Bag {
+        uint64_t epoch = 0;
+        std::vector<Retired> items;
+    };
+
+    // local_epoch is 0 while the thread is outside any guard, otherwise
+    // (pinned epoch << 1) | 1.
+    struct ThreadRecord {
+        std::atomic<uint64_t> local_epoch{0};
+        std::atomic<bool> in_use{false};
+        ThreadRecord* next = nullptr;
+        unsigned nesting = 0;
+        size_t retires_since_advance = 0;
+        Bag bags[3];            // indexed by epoch % 3
+    };
+
+    // Attempt an epoch advance after this many retires on one thread.
+    static constexpr size_t ADVANCE_INTERVAL = 64;
+
+    std::atomic<uint64_t> global_epoch{1};
+    std::atomic<ThreadRecord*> records{nullptr};
+
+    std::mutex orphan_mutex;
+    std::vector<Bag> orphans;   // bags left behind by exited threads
+
+    EpochReclaimer() = default;
+
+    static void free_bag(Bag& bag) {
+        for (const Retired& item : bag.items) {
+            item.destroy(item.ptr);
+        }
+        bag.items.clear();
+    }
+
+    ThreadRecord* acquire_record() {
+        for (ThreadRecord* record = records.load(std::memory_order_acquire); record; record = record->next) {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+        ThreadRecord* record = new ThreadRecord();
+        record->in_use.store(true, std::memory_order_relaxed);
+        ThreadRecord* head = records.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!records.compare_exchange_weak(head, record, std::memory_order_release,
+                                                std::memory_order_relaxed));
+        return record;
+    }
+
+    // Hands the record back when its thread exits.
+    struct ThreadHandle {
+        EpochReclaimer* domain = nullptr;
+        ThreadRecord* record = nullptr;
+
+        ~ThreadHandle() {
+            if (!record) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(domain->orphan_mutex);
+                for (Bag& bag : record->bags) {
+                    if (!bag.items.empty()) {
+                        domain->orphans.push_back(std::move(bag));
+                        bag = Bag();
+                    }
+                }
+            }
+            record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    ThreadRecord& local() {
+        thread_local ThreadHandle handle;
+        if (!handle.record) {
+            handle.domain = this;
+            handle.record = acquire_record();
+        }
+        return *handle.record;
+    }
+
+    // Frees this thread's bags (and orphans) that are two epochs old.
+    void collect(ThreadRecord& self, uint64_t epoch) {
+        for (Bag& bag : self.bags) {
+            if (!bag.items.empty() && bag.epoch + 2 <= epoch) {
+                free_bag(bag);
+            }
+        }
+        std::unique_lock<std::mutex> lock(orphan_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        for (size_t i = 0; i < orphans.size();) {
+            if (orphans[i].epoch + 2 <= epoch) {
+                free_bag(orphans[i]);
+                orphans[i] = std::move(orphans.back());
+                orphans.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+public:
+    // Keeps the calling thread pinned; nodes reachable when the guard was
+    // taken stay allocated until it is released. Guards nest.
+    class Guard {
+    private:
+        ThreadRecord* record;
+
+    public:
+        explicit Guard(EpochReclaimer& domain) : record(&domain.local()) {
+            if (record->nesting++ == 0) {
+                uint64_t epoch = domain.global_epoch.load(std::memory_order_seq_cst);
+                // seq_cst so the pin is visible before any node is read.
+                record->local_epoch.store(epoch << 1 | 1, std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (--record->nesting == 0) {
+                record->local_epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    static EpochReclaimer& instance() {
+        static EpochReclaimer domain;
+        return domain;
+    }
+
+    // Only safe once no other thread uses the domain (process exit).
+    ~EpochReclaimer() {
+        for (ThreadRecord* record = records.load(std::memory_order_acquire); record;) {
+            ThreadRecord* next = record->next;
+            for (Bag& bag : record->bags) {
+                free_bag(bag);
+            }
+            delete record;
+            record = next;
+        }
+        for (Bag& bag : orphans) {
+            free_bag(bag);
+        }
+    }
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    Guard pin() { return Guard(*this); }
+
+    // Defers `delete ptr` until no reader can still see it. The caller
+    // must already have unlinked ptr so that new readers can't reach it.
+    template<typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    void retire(void* ptr, void (*destroy)(void*)) {
+        ThreadRecord& self = local();
+        uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+        Bag& bag = self.bags[epoch % 3];
+        if (bag.epoch != epoch) {
+            // The bag last held epoch - 3 or older: safe to empty now.
+            free_bag(bag);
+            bag.epoch = epoch;
+        }
+        bag.items.push_back(Retired{ptr, destroy});
+        if (++self.retires_since_advance >= ADVANCE_INTERVAL) {
+            self.retires_since_advance = 0;
+            try_advance();
+        }
+    }
+
+    // Moves the global epoch on if every pinned thread has caught up with
+    // it, then frees whatever this thread can.
+    bool try_advance() {
+        ThreadRecord& self = local();
+        uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+        for (ThreadRecord* record = records.load(std::memory_order_acquire); record; record = record->next) {
+            uint64_t seen = record->local_epoch.load(std::memory_order_seq_cst);
+            if ((seen & 1) && (seen >> 1) != epoch) {
+                collect(self, epoch);
+                return false;
+            }
+        }
+        bool advanced = global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+        collect(self, advanced ? epoch + 1 : epoch);
+        return advanced;
+    }
+
+    // Frees everything retired so far. Only for quiescent points (tests,
+    // shutdown) where no thread is inside a guard.
+    void drain() {
+        for (int i = 0; i < 3; ++i) {
+            try_advance();
+        }
+    }
+
+    uint64_t epoch() const { return global_epoch.load(std::memory_order_relaxed); }
+
+    // Items retired by this thread and not yet freed.
+    size_t pending() {
+        ThreadRecord& self = local();
+        size_t count = 0;
+        for (const Bag& bag : self.bags) {
+            count += bag.items.size();
+        }
+        return count;
+    }
+};
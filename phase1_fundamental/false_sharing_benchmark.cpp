@@ -0,0 +1,113 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "layout_inspector.h"
+
+// Four threads each incrementing their own counter. In SharedLine the four
+// counters sit in one 64-byte line, so every increment has to take the
+// line away from whichever core wrote it last; in PaddedLines each counter
+// has a line to itself. The layout inspector's report for both structs is
+// printed first, flagging the first one.
+//
+// The cost only appears when the threads really run on different cores;
+// with one CPU they take turns and both layouts run at the same speed.
+class FalseSharingBenchmark {
+public:
+    static constexpr int THREADS = 4;
+
+    struct SharedLine {
+        std::atomic<uint64_t> counter0{0};
+        std::atomic<uint64_t> counter1{0};
+        std::atomic<uint64_t> counter2{0};
+        std::atomic<uint64_t> counter3{0};
+
+        std::atomic<uint64_t>& operator[](int i) {
+            return i == 0 ? counter0 : i == 1 ? counter1 : i == 2 ? counter2 : counter3;
+        }
+    };
+
+    struct PaddedLines {
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> counter0{0};
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> counter1{0};
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> counter2{0};
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> counter3{0};
+
+        std::atomic<uint64_t>& operator[](int i) {
+            return i == 0 ? counter0 : i == 1 ? counter1 : i == 2 ? counter2 : counter3;
+        }
+    };
+
+    template<typename Counters>
+    static layout::Layout describe(const char* name) {
+        return layout::Layout(name, sizeof(Counters), alignof(Counters), {
+            LAYOUT_WRITTEN_BY(Counters, counter0, "thread 0"),
+            LAYOUT_WRITTEN_BY(Counters, counter1, "thread 1"),
+            LAYOUT_WRITTEN_BY(Counters, counter2, "thread 2"),
+            LAYOUT_WRITTEN_BY(Counters, counter3, "thread 3"),
+        });
+    }
+
+    // One call: every thread does `increments` relaxed fetch_adds on its
+    // own counter, starting together.
+    template<typename Counters>
+    static void run(Counters& counters, long increments) {
+        std::atomic<int> ready{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < THREADS; ++t) {
+            workers.emplace_back([&counters, &ready, increments, t] {
+                ready.fetch_add(1);
+                while (ready.load() < THREADS) {
+                }
+                std::atomic<uint64_t>& counter = counters[t];
+                for (long i = 0; i < increments; ++i) {
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    long increments = 10000000;
+    if (argc > 1 && argv[1][0] != '-') {
+        increments = std::atol(argv[1]);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 5;
+    bench::Suite suite("false_sharing_benchmark", argc, argv, options);
+
+    FalseSharingBenchmark::describe<FalseSharingBenchmark::SharedLine>("SharedLine").print(std::cout);
+    std::cout << "\n";
+    FalseSharingBenchmark::describe<FalseSharingBenchmark::PaddedLines>("PaddedLines").print(std::cout);
+    std::cout << "\n";
+
+    const size_t ops = static_cast<size_t>(increments) * FalseSharingBenchmark::THREADS;
+    FalseSharingBenchmark::SharedLine shared;
+    auto shared_result = suite.run_once("4 counters, one line", [&] {
+        FalseSharingBenchmark::run(shared, increments);
+    }, ops);
+    FalseSharingBenchmark::PaddedLines padded;
+    auto padded_result = suite.run_once("4 counters, padded", [&] {
+        FalseSharingBenchmark::run(padded, increments);
+    }, ops);
+
+    unsigned cpus = std::thread::hardware_concurrency();
+    std::printf("\n%d threads x %ld increments, %u CPU%s\n", FalseSharingBenchmark::THREADS, increments, cpus,
+                cpus == 1 ? " (threads take turns; no cross-core traffic to measure)" : "");
+    std::printf("%-24s %10s\n", "layout", "ns/inc");
+    std::printf("%-24s %10.2f\n", "one line", shared_result.median);
+    std::printf("%-24s %10.2f\n", "padded (alignas)", padded_result.median);
+    std::printf("shared line is %.2fx slower\n", shared_result.median / padded_result.median);
+    return 0;
+}
@@ -0,0 +1,527 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define FILE_WRITER_IO_URING 1
+#endif
+
+// Owns a FILE*: fclose on destruction, move-only, and never fclose(nullptr)
+// when fopen failed.
+class FileHandle {
+private:
+    FILE* file = nullptr;
+
+public:
+    FileHandle() = default;
+    FileHandle(const char* path, const char* mode) : file(std::fopen(path, mode)) {}
+    explicit FileHandle(FILE* owned) : file(owned) {}
+
+    ~FileHandle() { close(); }
+
+    FileHandle(FileHandle&& other) noexcept : file(std::exchange(other.file, nullptr)) {}
+
+    FileHandle& operator=(FileHandle&& other) noexcept {
+        if (this != &other) {
+            close();
+            file = std::exchange(other.file, nullptr);
+        }
+        return *this;
+    }
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    // fclose's result; 0 if there was nothing to close.
+    int close() {
+        return file ? std::fclose(std::exchange(file, nullptr)) : 0;
+    }
+
+    FILE* get() const { return file; }
+    FILE* release() { return std::exchange(file, nullptr); }
+    explicit operator bool() const { return file != nullptr; }
+};
+
+namespace file_writer_detail {
+
+struct WriteRequest {
+    const char* data;
+    size_t size;
+    off_t offset;
+};
+
+// Finishes a write with pwrite; 0 or an errno.
+inline int pwrite_all(int fd, const char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t written = ::pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return 0;
+}
+
+#ifdef FILE_WRITER_IO_URING
+
+// Just enough io_uring, on raw syscalls (no liburing), to submit a batch
+// of writes with one io_uring_enter and wait for them.
+class IoUring {
+private:
+    int ring_fd = -1;
+    void* sq_map = nullptr;
+    size_t sq_map_size = 0;
+    void* cq_map = nullptr;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+public:
+    IoUring() = default;
+    ~IoUring() { close(); }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // False if the kernel (or a seccomp filter) doesn't allow io_uring.
+    bool open(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return false;
+        }
+        ring_fd = fd;
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_map) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                      IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            sq_map = nullptr;
+            close();
+            return false;
+        }
+        if (single_map) {
+            cq_map = sq_map;
+        } else {
+            cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                          IORING_OFF_CQ_RING);
+            if (cq_map == MAP_FAILED) {
+                cq_map = nullptr;
+                close();
+                return false;
+            }
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqe_map = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_SQES);
+        if (sqe_map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqe_map);
+
+        char* sq = static_cast<char*>(sq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        char* cq = static_cast<char*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if (sqes) {
+            munmap(sqes, sqes_size);
+            sqes = nullptr;
+        }
+        if (cq_map && cq_map != sq_map) {
+            munmap(cq_map, cq_map_size);
+        }
+        cq_map = nullptr;
+        if (sq_map) {
+            munmap(sq_map, sq_map_size);
+            sq_map = nullptr;
+        }
+        if (ring_fd >= 0) {
+            ::close(ring_fd);
+            ring_fd = -1;
+        }
+    }
+
+    unsigned capacity() const { return sq_entries; }
+
+    // Submits count <= capacity() writes and waits for all of them.
+    // results[i] is the byte count written or -errno. False if
+    // io_uring_enter itself failed; even then every write the kernel had
+    // already taken has completed on return, so the caller may rewrite
+    // and reuse the buffers.
+    bool write(int fd, const WriteRequest* requests, size_t count, int* results) {
+        const unsigned first = *sq_tail;    // only this thread moves the tail
+        unsigned tail = first;
+        for (size_t i = 0; i < count; ++i) {
+            unsigned index = tail & sq_mask;
+            io_uring_sqe* sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->fd = fd;
+            sqe->addr = reinterpret_cast<uint64_t>(requests[i].data);
+            sqe->len = static_cast<uint32_t>(requests[i].size);
+            sqe->off = static_cast<uint64_t>(requests[i].offset);
+            sqe->user_data = i;
+            sq_array[index] = index;
+            ++tail;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        bool ok = true;
+        size_t completed = 0;
+        while (true) {
+            // SQEs the kernel has consumed; only these can be in flight.
+            size_t taken = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) - first;
+            size_t waiting = (ok ? count : taken) - completed;
+            if (waiting == 0) {
+                break;
+            }
+            long entered = syscall(__NR_io_uring_enter, ring_fd, static_cast<unsigned>(ok ? count - taken : 0),
+                                   static_cast<unsigned>(waiting), IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (entered < 0 && errno != EINTR) {
+                if (ok) {
+                    // Give up on the rest, but drop the SQEs the kernel
+                    // never took and wait out the ones it did: their
+                    // buffers stay in use until they complete.
+                    ok = false;
+                    taken = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) - first;
+                    __atomic_store_n(sq_tail, first + static_cast<unsigned>(taken), __ATOMIC_RELEASE);
+                } else {
+                    std::this_thread::yield();  // enter keeps failing: poll the completion queue
+                }
+            }
+            unsigned head = *cq_head;
+            while (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                results[cqe.user_data] = cqe.res;
+                ++head;
+                ++completed;
+            }
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+        return ok;
+    }
+};
+
+#endif // FILE_WRITER_IO_URING
+
+} // namespace file_writer_detail
+
+// Move-only file writer that keeps disk I/O off the calling thread.
+//
+// write() copies into the current buffer. A full buffer goes onto a
+// queue for the I/O thread and the caller continues in a fresh one. The
+// queue is bounded: with queue_depth buffers waiting or being written,
+// the next hand-off blocks until the I/O thread catches up (stalls()
+// counts those waits), so a slow disk pushes back instead of growing
+// memory.
+//
+// The I/O thread writes each batch of queued buffers with one
+// io_uring_enter, or with pwrite when io_uring is unavailable (old
+// kernel, seccomp) or Backend::Pwrite is asked for; backend() says which
+// one is in use. Sync chooses when data is forced to disk with
+// fdatasync: never, at flush()/close(), or after every buffer.
+//
+// Errors are sticky: the first failed write or sync is kept, later
+// flush()/close() return false and error() has the errno. Opening the
+// file throws std::system_error.
+class AsyncFileWriter {
+public:
+    enum class Backend { Auto, Pwrite, IoUring };
+    enum class Sync { Never, OnFlush, EveryBuffer };
+
+    struct Options {
+        size_t buffer_bytes = 256 * 1024;
+        size_t queue_depth = 4;         // buffers queued or being written
+        Sync sync = Sync::OnFlush;
+        Backend backend = Backend::Auto;
+        bool append = false;            // keep existing contents
+    };
+
+private:
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        size_t used = 0;
+        off_t offset = 0;
+    };
+
+    struct State {
+        int fd = -1;
+        Options options;
+        std::atomic<Backend> backend{Backend::Pwrite};     // switched by the I/O thread, read by backend()
+#ifdef FILE_WRITER_IO_URING
+        file_writer_detail::IoUring ring;
+#endif
+
+        // Caller side.
+        Buffer current;
+        off_t next_offset = 0;
+
+        // Shared with the I/O thread, under `mutex`.
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Buffer> queue;
+        std::vector<std::unique_ptr<char[]>> spare;
+        size_t in_flight = 0;
+        bool stopping = false;
+        int error = 0;
+        size_t stalls = 0;
+        size_t buffers_written = 0;
+
+        std::thread io;
+    };
+
+    std::unique_ptr<State> state;
+
+    static int write_batch(State& s, std::vector<Buffer>& batch) {
+        int error = 0;
+#ifdef FILE_WRITER_IO_URING
+        if (s.backend == Backend::IoUring) {
+            std::vector<file_writer_detail::WriteRequest> requests;
+            std::vector<int> results;
+            for (size_t first = 0; first < batch.size(); first += s.ring.capacity()) {
+                size_t count = std::min<size_t>(s.ring.capacity(), batch.size() - first);
+                requests.clear();
+                for (size_t i = first; i < first + count; ++i) {
+                    requests.push_back({batch[i].data.get(), batch[i].used, batch[i].offset});
+                }
+                results.assign(count, 0);
+                if (!s.ring.write(s.fd, requests.data(), count, results.data())) {
+                    s.backend = Backend::Pwrite;        // enter failed: stop using the ring
+                    results.assign(count, 0);
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    const Buffer& buffer = batch[first + i];
+                    int result = results[i];
+                    if (result == -EINVAL || result == -EOPNOTSUPP) {
+                        s.backend = Backend::Pwrite;    // no IORING_OP_WRITE on this kernel
+                        result = 0;
+                    }
+                    int failed = result < 0 ? -result
+                               : file_writer_detail::pwrite_all(s.fd, buffer.data.get() + result,
+                                                                buffer.used - result, buffer.offset + result);
+                    error = error ? error : failed;
+                }
+            }
+            return error;
+        }
+#endif
+        for (const Buffer& buffer : batch) {
+            int failed = file_writer_detail::pwrite_all(s.fd, buffer.data.get(), buffer.used, buffer.offset);
+            error = error ? error : failed;
+        }
+        return error;
+    }
+
+    static void io_loop(State& s) {
+        std::vector<Buffer> batch;
+        std::unique_lock<std::mutex> lock(s.mutex);
+        while (true) {
+            s.changed.wait(lock, [&s] { return !s.queue.empty() || s.stopping; });
+            if (s.queue.empty()) {
+                return;
+            }
+            batch.assign(std::make_move_iterator(s.queue.begin()), std::make_move_iterator(s.queue.end()));
+            s.queue.clear();
+            s.in_flight = batch.size();
+            lock.unlock();
+
+            int error = write_batch(s, batch);
+            if (!error && s.options.sync == Sync::EveryBuffer && fdatasync(s.fd) != 0) {
+                error = errno;
+            }
+
+            lock.lock();
+            s.error = s.error ? s.error : error;
+            s.buffers_written += batch.size();
+            for (Buffer& buffer : batch) {
+                s.spare.push_back(std::move(buffer.data));
+            }
+            batch.clear();
+            s.in_flight = 0;
+            s.changed.notify_all();
+        }
+    }
+
+    // Queues the current buffer (blocking while the queue is full) and
+    // starts a new one.
+    void submit() {
+        State& s = *state;
+        if (s.current.used == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(s.mutex);
+        if (s.queue.size() + s.in_flight >= s.options.queue_depth) {
+            ++s.stalls;
+            s.changed.wait(lock, [&s] { return s.queue.size() + s.in_flight < s.options.queue_depth; });
+        }
+        s.next_offset += static_cast<off_t>(s.current.used);
+        s.queue.push_back(std::move(s.current));
+        if (s.spare.empty()) {
+            s.current.data.reset(new char[s.options.buffer_bytes]);
+        } else {
+            s.current.data = std::move(s.spare.back());
+            s.spare.pop_back();
+        }
+        s.current.used = 0;
+        s.current.offset = s.next_offset;
+        s.changed.notify_all();
+    }
+
+public:
+    explicit AsyncFileWriter(const std::string& path) : AsyncFileWriter(path, Options()) {}
+
+    AsyncFileWriter(const std::string& path, Options opts) : state(new State()) {
+        State& s = *state;
+        s.options = opts;
+        s.options.buffer_bytes = std::max<size_t>(s.options.buffer_bytes, 4096);
+        s.options.queue_depth = std::max<size_t>(s.options.queue_depth, 1);
+        s.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (opts.append ? 0 : O_TRUNC), 0644);
+        if (s.fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        if (opts.append) {
+            s.next_offset = lseek(s.fd, 0, SEEK_END);
+        }
+#ifdef FILE_WRITER_IO_URING
+        if (opts.backend != Backend::Pwrite && s.ring.open(static_cast<unsigned>(s.options.queue_depth))) {
+            s.backend = Backend::IoUring;
+        }
+#endif
+        s.current.data.reset(new char[s.options.buffer_bytes]);
+        s.current.offset = s.next_offset;
+        s.io = std::thread([&s] { io_loop(s); });
+    }
+
+    ~AsyncFileWriter() { close(); }
+
+    AsyncFileWriter(AsyncFileWriter&&) noexcept = default;
+
+    AsyncFileWriter& operator=(AsyncFileWriter&& other) noexcept {
+        if (this != &other) {
+            close();
+            state = std::move(other.state);
+        }
+        return *this;
+    }
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    void write(const char* data, size_t size) {
+        State& s = *state;
+        while (size > 0) {
+            size_t room = s.options.buffer_bytes - s.current.used;
+            size_t chunk = std::min(room, size);
+            std::memcpy(s.current.data.get() + s.current.used, data, chunk);
+            s.current.used += chunk;
+            data += chunk;
+            size -= chunk;
+            if (s.current.used == s.options.buffer_bytes) {
+                submit();
+            }
+        }
+    }
+
+    void write(std::string_view text) { write(text.data(), text.size()); }
+
+    // Waits until everything written so far is in the file (and on disk
+    // unless Sync::Never). False if any write or sync has failed.
+    bool flush() {
+        State& s = *state;
+        submit();
+        std::unique_lock<std::mutex> lock(s.mutex);
+        s.changed.wait(lock, [&s] { return s.queue.empty() && s.in_flight == 0; });
+        if (!s.error && s.options.sync != Sync::Never && fdatasync(s.fd) != 0) {
+            s.error = errno;
+        }
+        return s.error == 0;
+    }
+
+    // Flushes, stops the I/O thread and closes the file. Idempotent.
+    bool close() {
+        if (!state) {
+            return true;
+        }
+        bool ok = flush();
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->stopping = true;
+        }
+        state->changed.notify_all();
+        state->io.join();
+        if (::close(state->fd) != 0 && ok) {
+            ok = false;
+        }
+        state.reset();
+        return ok;
+    }
+
+    bool is_open() const { return state != nullptr; }
+    Backend backend() const { return state->backend; }
+    int error() {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->error;
+    }
+    // Hand-offs that had to wait for a full queue.
+    size_t stalls() {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->stalls;
+    }
+    size_t buffers_written() {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->buffers_written;
+    }
+};
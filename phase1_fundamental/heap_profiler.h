@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <execinfo.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "alloc_tracker.h"
+
+// Sampling heap profiler, in the style of tcmalloc's heap sampler.
+//
+// Define HEAP_PROFILER in exactly one translation unit (or pass
+// -DHEAP_PROFILER) to replace the global operator new/delete. Each thread
+// counts down a byte budget drawn from an exponential distribution with
+// mean sample_rate(); the allocation that crosses it is sampled: its stack
+// is captured with backtrace() and kept in a live-sample table until it is
+// freed. Sampling by bytes rather than by calls makes the chance of seeing
+// an allocation proportional to its size, so each sample is weighted by
+// size / (1 - exp(-size / rate)) to estimate the bytes it stands for.
+//
+// dump() writes either profile in the collapsed-stack format that
+// flamegraph.pl reads ("main;f;g 4096" per line). At exit the in-use and
+// allocated profiles go to $HEAP_PROFILE.inuse.collapsed and
+// $HEAP_PROFILE.alloc.collapsed (prefix "heap_profile" by default). Link
+// with -rdynamic so frames in the main program get function names.
+//
+// The sampling interval comes from $HEAP_PROFILE_RATE (bytes, default
+// 512 KiB; 1 samples every allocation, 0 turns sampling off) or
+// set_sample_rate(). Unsampled allocations pay a 16-byte header and one
+// thread-local subtraction.
+namespace heap_profiler {
+
+#ifdef HEAP_PROFILER
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+enum class Profile {
+    InUse,      // sampled blocks that are still allocated
+    Allocated,  // every sample taken since start-up
+};
+
+struct Stats {
+    uint64_t samples = 0;               // samples taken so far
+    uint64_t live_samples = 0;          // of which still allocated
+    double estimated_live_bytes = 0;    // weighted sum over live samples
+};
+
+namespace detail {
+
+constexpr int MAX_FRAMES = 48;
+constexpr int64_t DEFAULT_SAMPLE_RATE = 512 * 1024;
+// Budget handed out while sampling is off, so a later set_sample_rate()
+// is picked up after at most this many bytes per thread.
+constexpr int64_t DISABLED_RECHECK_BYTES = 16 * 1024 * 1024;
+
+inline int64_t initial_sample_rate() {
+    const char* value = std::getenv("HEAP_PROFILE_RATE");
+    return value ? std::atoll(value) : DEFAULT_SAMPLE_RATE;
+}
+
+inline std::atomic<int64_t> sample_rate{initial_sample_rate()};
+
+struct Sample {
+    size_t size;
+    double weight;
+    int depth;
+    void* frames[MAX_FRAMES];   // innermost first, starting at the caller of new
+};
+
+struct Totals {
+    double bytes = 0;
+    uint64_t samples = 0;
+};
+
+struct State {
+    std::mutex mutex;
+    std::unordered_map<void*, Sample> live;
+    std::map<std::vector<void*>, Totals> allocated;
+    uint64_t samples = 0;
+};
+
+// Created on first use and never destroyed, so the exit dump and frees
+// from late static destructors still find it.
+inline State& state() {
+    static State* instance = new State();
+    return *instance;
+}
+
+// Plain thread_locals: constant-initialized, so no TLS guard on the hot path.
+inline thread_local int64_t bytes_until_sample = 0;
+inline thread_local bool primed = false;
+inline thread_local bool in_profiler = false;
+inline thread_local uint64_t rng = 0;
+
+// Allocations made by the profiler itself (table nodes, strings) must not
+// be sampled, or they would re-enter the table lock.
+class Reentry {
+private:
+    bool saved;
+
+public:
+    Reentry() : saved(in_profiler) { in_profiler = true; }
+    ~Reentry() { in_profiler = saved; }
+};
+
+// Exponentially distributed gap with mean `rate`: the bytes between two
+// samples of a Poisson process.
+inline int64_t next_interval(int64_t rate) {
+    if (rng == 0) {
+        rng = reinterpret_cast<uintptr_t>(&rng) * 0x9E3779B97F4A7C15ull | 1;
+    }
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    double u = static_cast<double>((rng * 0x2545F4914F6CDD1Dull) >> 11) * 0x1.0p-53;
+    double interval = -std::log1p(-u) * static_cast<double>(rate);
+    return std::max<int64_t>(1, static_cast<int64_t>(interval));
+}
+
+// Block header; 16 bytes so the user pointer keeps malloc's alignment.
+struct Header {
+    size_t size;
+    size_t sampled;
+};
+static_assert(sizeof(Header) == 16, "header must preserve 16-byte alignment");
+
+__attribute__((noinline)) inline void record_sample(Header* header, uintptr_t site) {
+    Reentry reentry;
+    Sample sample;
+    sample.size = header->size;
+    double rate = static_cast<double>(sample_rate.load(std::memory_order_relaxed));
+    double size = static_cast<double>(header->size);
+    sample.weight = size > 0 ? size / -std::expm1(-size / rate) : rate;
+
+    void* frames[MAX_FRAMES];
+    int depth = backtrace(frames, MAX_FRAMES);
+    // Drop the profiler's own frames: keep everything from the frame that
+    // returns to `site`, the caller of operator new.
+    int first = 0;
+    for (int i = 0; i < depth; ++i) {
+        if (reinterpret_cast<uintptr_t>(frames[i]) == site) {
+            first = i;
+            break;
+        }
+    }
+    sample.depth = depth - first;
+    std::copy(frames + first, frames + depth, sample.frames);
+
+    State& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    ++profile.samples;
+    Totals& totals = profile.allocated[std::vector<void*>(sample.frames, sample.frames + sample.depth)];
+    totals.bytes += sample.weight;
+    ++totals.samples;
+    profile.live.emplace(header + 1, sample);
+    header->sampled = 1;
+}
+
+// Slow path, taken once the thread's byte budget runs out.
+__attribute__((noinline)) inline void budget_exhausted(Header* header, uintptr_t site) {
+    if (in_profiler) {
+        return;
+    }
+    int64_t rate = sample_rate.load(std::memory_order_relaxed);
+    if (rate <= 0) {
+        bytes_until_sample = DISABLED_RECHECK_BYTES;
+        primed = false;
+        return;
+    }
+    if (!primed) {
+        // First allocation on this thread (or since sampling was turned
+        // on): start a fresh interval and charge this allocation to it.
+        primed = true;
+        bytes_until_sample = next_interval(rate) - static_cast<int64_t>(header->size);
+        if (bytes_until_sample >= 0) {
+            return;
+        }
+    }
+    bytes_until_sample = next_interval(rate);
+    record_sample(header, site);
+}
+
+inline void* profiled_allocate(size_t size, uintptr_t site) {
+    Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+    if (!header) {
+        return nullptr;
+    }
+    header->size = size;
+    header->sampled = 0;
+    bytes_until_sample -= static_cast<int64_t>(size);
+    if (__builtin_expect(bytes_until_sample < 0, 0)) {
+        budget_exhausted(header, site);
+    }
+    return header + 1;
+}
+
+__attribute__((noinline)) inline void forget_sample(void* ptr) {
+    Reentry reentry;
+    State& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    profile.live.erase(ptr);
+}
+
+inline void profiled_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    // Integer arithmetic: GCC's bounds checker follows inlined container
+    // deallocations here and flags the step back to the header.
+    Header* header = reinterpret_cast<Header*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Header));
+    if (__builtin_expect(header->sampled != 0, 0)) {
+        forget_sample(ptr);
+    }
+    std::free(header);
+}
+
+} // namespace detail
+
+inline int64_t sample_rate() {
+    return detail::sample_rate.load(std::memory_order_relaxed);
+}
+
+// Mean bytes between samples; 1 samples everything, 0 stops sampling.
+// Threads pick up the new rate at their next sample.
+inline void set_sample_rate(int64_t bytes) {
+    detail::sample_rate.store(bytes, std::memory_order_relaxed);
+    detail::bytes_until_sample = 0;
+    detail::primed = false;
+}
+
+inline Stats stats() {
+    Stats result;
+    if (!enabled) {
+        return result;
+    }
+    detail::Reentry reentry;
+    detail::State& profile = detail::state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    result.samples = profile.samples;
+    result.live_samples = profile.live.size();
+    for (const auto& entry : profile.live) {
+        result.estimated_live_bytes += entry.second.weight;
+    }
+    return result;
+}
+
+// Writes `profile` as collapsed stacks, outermost frame first, one line
+// per distinct stack with its estimated bytes.
+inline void dump(std::ostream& out, Profile profile = Profile::InUse) {
+    if (!enabled) {
+        return;
+    }
+    detail::Reentry reentry;
+    std::map<std::vector<void*>, double> stacks;
+    {
+        detail::State& state = detail::state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (profile == Profile::InUse) {
+            for (const auto& entry : state.live) {
+                const detail::Sample& sample = entry.second;
+                stacks[std::vector<void*>(sample.frames, sample.frames + sample.depth)] += sample.weight;
+            }
+        } else {
+            for (const auto& entry : state.allocated) {
+                stacks[entry.first] += entry.second.bytes;
+            }
+        }
+    }
+
+    // Symbolize outside the lock; many samples share the same frames, and
+    // stacks that differ only in call offsets merge into one line.
+    std::unordered_map<void*, std::string> names;
+    std::map<std::string, double> lines;
+    for (const auto& stack : stacks) {
+        std::string line;
+        for (auto frame = stack.first.rbegin(); frame != stack.first.rend(); ++frame) {
+            auto known = names.find(*frame);
+            if (known == names.end()) {
+                // Return addresses point past the call; step back into it.
+                std::string name = alloc_tracker::symbolize(reinterpret_cast<uintptr_t>(*frame) - 1, false);
+                for (char& c : name) {
+                    if (c == ';') {
+                        c = ':';
+                    }
+                }
+                known = names.emplace(*frame, std::move(name)).first;
+            }
+            if (!line.empty()) {
+                line += ';';
+            }
+            line += known->second;
+        }
+        lines[line] += stack.second;
+    }
+    for (const auto& line : lines) {
+        out << line.first << ' ' << static_cast<uint64_t>(line.second + 0.5) << '\n';
+    }
+}
+
+inline bool dump(const std::string& path, Profile profile = Profile::InUse) {
+    detail::Reentry reentry;
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    dump(out, profile);
+    return static_cast<bool>(out);
+}
+
+namespace detail {
+
+inline void dump_at_exit() {
+    Reentry reentry;
+    const char* prefix = std::getenv("HEAP_PROFILE");
+    std::string base = prefix && *prefix ? prefix : "heap_profile";
+    Stats totals = stats();
+    bool written = dump(base + ".inuse.collapsed", Profile::InUse) &&
+                   dump(base + ".alloc.collapsed", Profile::Allocated);
+    std::fprintf(stderr, "heap_profiler: %llu samples (%llu live, ~%.0f bytes); %s %s.{inuse,alloc}.collapsed\n",
+                 static_cast<unsigned long long>(totals.samples),
+                 static_cast<unsigned long long>(totals.live_samples),
+                 totals.estimated_live_bytes, written ? "wrote" : "could not write", base.c_str());
+}
+
+} // namespace detail
+
+} // namespace heap_profiler
+
+#if defined(HEAP_PROFILER) && defined(MEMORY_TRACKER)
+
+#error "HEAP_PROFILER and MEMORY_TRACKER both replace operator new; enable one of them"
+
+#elif defined(HEAP_PROFILER)
+
+#define HEAP_PROFILER_SITE reinterpret_cast<uintptr_t>(__builtin_return_address(0))
+
+inline const bool heap_profiler_exit_dump = (std::atexit(heap_profiler::detail::dump_at_exit), true);
+
+void* operator new(size_t size) {
+    void* ptr = heap_profiler::detail::profiled_allocate(size, HEAP_PROFILER_SITE);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = heap_profiler::detail::profiled_allocate(size, HEAP_PROFILER_SITE);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return heap_profiler::detail::profiled_allocate(size, HEAP_PROFILER_SITE);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return heap_profiler::detail::profiled_allocate(size, HEAP_PROFILER_SITE);
+}
+
+void operator delete(void* ptr) noexcept { heap_profiler::detail::profiled_free(ptr); }
+void operator delete[](void* ptr) noexcept { heap_profiler::detail::profiled_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { heap_profiler::detail::profiled_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { heap_profiler::detail::profiled_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { heap_profiler::detail::profiled_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { heap_profiler::detail::profiled_free(ptr); }
+
+#undef HEAP_PROFILER_SITE
+
+#endif
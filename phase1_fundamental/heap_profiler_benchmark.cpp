@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "heap_profiler.h"
+
+// Build with -DHEAP_PROFILER (and -rdynamic for readable stacks):
+//   g++ -std=c++17 -O2 -rdynamic -DHEAP_PROFILER heap_profiler_benchmark.cpp -o heap_profiler_benchmark
+// Without it the same numbers show the plain allocator for comparison.
+class HeapProfilerBenchmark {
+public:
+    static constexpr int BATCH = 1000;
+
+    // One call allocates BATCH blocks of 16..1024 bytes through operator
+    // new, touches them and frees them again.
+    static void churn(std::vector<char*>& held) {
+        for (int i = 0; i < BATCH; ++i) {
+            size_t size = 16 + static_cast<size_t>(i * 37 % 64) * 16;
+            char* block = new char[size];
+            block[0] = static_cast<char>(i);
+            held[i] = block;
+        }
+        bench::DoNotOptimize(held.data());
+        for (int i = 0; i < BATCH; ++i) {
+            delete[] held[i];
+        }
+    }
+
+    static void measureOverhead(bench::Suite& suite) {
+        std::vector<char*> held(BATCH);
+
+        auto baseline = suite.run("malloc/free (no hook)", [&] {
+            for (int i = 0; i < BATCH; ++i) {
+                size_t size = 16 + static_cast<size_t>(i * 37 % 64) * 16;
+                char* block = static_cast<char*>(std::malloc(size));
+                block[0] = static_cast<char>(i);
+                held[i] = block;
+            }
+            bench::DoNotOptimize(held.data());
+            for (int i = 0; i < BATCH; ++i) {
+                std::free(held[i]);
+            }
+        }, BATCH);
+
+        const int64_t rates[] = {0, 4 << 20, 512 << 10, 64 << 10, 4 << 10, 256, 1};
+        std::cout << "\nrate (bytes)\tns/alloc+free\toverhead vs malloc\tsamples\n";
+        std::vector<std::string> lines;
+        for (int64_t rate : rates) {
+            heap_profiler::set_sample_rate(rate);
+            uint64_t before = heap_profiler::stats().samples;
+            std::string label = rate == 0 ? "off" : std::to_string(rate);
+            auto result = suite.run("new/delete sample_rate=" + label, [&] { churn(held); }, BATCH);
+            uint64_t taken = heap_profiler::stats().samples - before;
+            lines.push_back(label + "\t\t" + std::to_string(result.median) + "\t" +
+                            std::to_string((result.median / baseline.median - 1) * 100) + "%\t\t" +
+                            std::to_string(taken));
+        }
+        for (const auto& line : lines) {
+            std::cout << line << "\n";
+        }
+        heap_profiler::set_sample_rate(512 << 10);
+    }
+};
+
+int main(int argc, char** argv) {
+    if (!heap_profiler::enabled) {
+        std::cout << "heap profiler not compiled in (build with -DHEAP_PROFILER); "
+                     "all rates measure the default operator new\n";
+    }
+    bench::Suite suite("heap_profiler_benchmark", argc, argv);
+    HeapProfilerBenchmark::measureOverhead(suite);
+    return 0;
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+// Reference counting with the count inside the object.
+//
+// Derive from RefCounted<LocalCount> (plain increments, for objects that
+// stay on one thread) or RefCounted<AtomicCount> (safe to share across
+// threads) and hold the object through intrusive_ptr<T>. Compared with
+// std::shared_ptr there is no control block: one allocation, a pointer
+// that is 8 bytes instead of 16, and with LocalCount no atomic
+// read-modify-write on copy or destruction.
+//
+// Weak references (intrusive_weak_ptr) are optional and only available
+// with LocalCount. An object pays nothing for them until the first weak
+// reference is taken: then one bit in its count marks it and a WeakEntry
+// in a side table, keyed by the object's address, records whether it is
+// still alive.
+
+struct LocalCount {
+    static constexpr bool thread_safe = false;
+    static constexpr uint32_t WEAK_BIT = 1u << 31;   // object has a side-table entry
+    static constexpr uint32_t COUNT_MASK = WEAK_BIT - 1;
+
+    uint32_t value = 0;
+
+    void increment() { ++value; }
+    bool decrement() { return (--value & COUNT_MASK) == 0; }   // true for the last reference
+    uint32_t load() const { return value & COUNT_MASK; }
+
+    bool weak_listed() const { return (value & WEAK_BIT) != 0; }
+    void set_weak_listed(bool listed) { value = listed ? value | WEAK_BIT : value & COUNT_MASK; }
+};
+
+struct AtomicCount {
+    static constexpr bool thread_safe = true;
+
+    std::atomic<uint32_t> value{0};
+
+    // A new reference is always made from an existing one, so the
+    // increment needs no ordering; the decrement that reaches zero must
+    // see every write made through the other references before deleting.
+    void increment() { value.fetch_add(1, std::memory_order_relaxed); }
+    bool decrement() { return value.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    uint32_t load() const { return value.load(std::memory_order_relaxed); }
+};
+
+template<typename Count = LocalCount>
+class RefCounted {
+private:
+    template<typename> friend class intrusive_ptr;
+    template<typename> friend class intrusive_weak_ptr;
+
+    mutable Count refs;
+
+public:
+    using count_type = Count;
+
+    RefCounted() = default;
+    // A copy is a new object with its own references.
+    RefCounted(const RefCounted&) {}
+    RefCounted& operator=(const RefCounted&) { return *this; }
+
+    uint32_t use_count() const { return refs.load(); }
+};
+
+namespace intrusive_detail {
+
+// `object` is the RefCounted base rather than any particular T, so weak
+// pointers to different types in the hierarchy each convert back to their
+// own T (the base need not sit at offset 0 under multiple inheritance).
+struct WeakEntry {
+    const RefCounted<LocalCount>* object;     // nullptr once the object has been destroyed
+    uint32_t weak_refs;
+};
+
+// Side table from object address to its WeakEntry. Only touched when the
+// first weak reference to an object is taken and when such an object dies.
+struct WeakTable {
+    std::mutex mutex;
+    std::unordered_map<const void*, WeakEntry*> entries;
+};
+
+inline WeakTable& weak_table() {
+    static WeakTable table;
+    return table;
+}
+
+// Keyed by the RefCounted base, so base and derived pointers agree.
+template<typename T>
+const void* weak_key(const T* object) {
+    return static_cast<const RefCounted<typename T::count_type>*>(object);
+}
+
+} // namespace intrusive_detail
+
+template<typename T>
+class intrusive_ptr {
+private:
+    template<typename> friend class intrusive_ptr;
+    T* ptr = nullptr;
+
+    void release() {
+        if (ptr && ptr->refs.decrement()) {
+            if constexpr (!T::count_type::thread_safe) {
+                if (ptr->refs.weak_listed()) {
+                    expire_weak(ptr);
+                }
+            }
+            delete ptr;
+        }
+    }
+
+    template<typename U>
+    static constexpr void check_deletable_as() {
+        static_assert(std::is_same_v<std::remove_cv_t<U>, std::remove_cv_t<T>> || std::has_virtual_destructor_v<T>,
+                      "converting to intrusive_ptr<Base> deletes through Base*: give Base a virtual destructor");
+    }
+
+    static void expire_weak(const T* object) {
+        auto& table = intrusive_detail::weak_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto it = table.entries.find(intrusive_detail::weak_key(object));
+        it->second->object = nullptr;
+        table.entries.erase(it);
+    }
+
+public:
+    using element_type = T;
+
+    intrusive_ptr() = default;
+    intrusive_ptr(std::nullptr_t) {}
+
+    // Takes a reference to `object`, which may already have others.
+    explicit intrusive_ptr(T* object) : ptr(object) {
+        if (ptr) {
+            ptr->refs.increment();
+        }
+    }
+
+    intrusive_ptr(const intrusive_ptr& other) : intrusive_ptr(other.ptr) {}
+    intrusive_ptr(intrusive_ptr&& other) noexcept : ptr(std::exchange(other.ptr, nullptr)) {}
+
+    // Derived -> base conversions (implicit pointer conversions only, so
+    // no downcasts). The last reference may then be dropped through the
+    // base, which deletes through T*: T needs a virtual destructor.
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    intrusive_ptr(const intrusive_ptr<U>& other) : intrusive_ptr(other.ptr) {
+        check_deletable_as<U>();
+    }
+    template<typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    intrusive_ptr(intrusive_ptr<U>&& other) noexcept : ptr(std::exchange(other.ptr, nullptr)) {
+        check_deletable_as<U>();
+    }
+
+    ~intrusive_ptr() { release(); }
+
+    intrusive_ptr& operator=(const intrusive_ptr& other) {
+        intrusive_ptr(other).swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr& operator=(intrusive_ptr&& other) noexcept {
+        intrusive_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void reset() { intrusive_ptr().swap(*this); }
+    void swap(intrusive_ptr& other) noexcept { std::swap(ptr, other.ptr); }
+
+    T* get() const { return ptr; }
+    T& operator*() const { return *ptr; }
+    T* operator->() const { return ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+    uint32_t use_count() const { return ptr ? ptr->refs.load() : 0; }
+
+    friend bool operator==(const intrusive_ptr& a, const intrusive_ptr& b) { return a.ptr == b.ptr; }
+    friend bool operator!=(const intrusive_ptr& a, const intrusive_ptr& b) { return a.ptr != b.ptr; }
+};
+
+template<typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args) {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Non-owning reference that can tell whether its object is still alive.
+// Like the objects it points to, it must stay on one thread.
+template<typename T>
+class intrusive_weak_ptr {
+private:
+    static_assert(!T::count_type::thread_safe,
+                  "weak references need RefCounted<LocalCount>; share across threads with std::weak_ptr");
+
+    intrusive_detail::WeakEntry* entry = nullptr;
+
+    static intrusive_detail::WeakEntry* entry_for(const T* object) {
+        auto& table = intrusive_detail::weak_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        intrusive_detail::WeakEntry*& slot = table.entries[intrusive_detail::weak_key(object)];
+        if (!slot) {
+            slot = new intrusive_detail::WeakEntry{object, 0};   // converts to the RefCounted base
+            object->refs.set_weak_listed(true);
+        }
+        ++slot->weak_refs;
+        return slot;
+    }
+
+    void release() {
+        if (!entry || --entry->weak_refs != 0) {
+            return;
+        }
+        if (entry->object) {
+            // Last weak reference to a live object: unlist it again.
+            auto& table = intrusive_detail::weak_table();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            entry->object->refs.set_weak_listed(false);
+            table.entries.erase(entry->object);
+        }
+        delete entry;
+    }
+
+public:
+    intrusive_weak_ptr() = default;
+
+    intrusive_weak_ptr(const intrusive_ptr<T>& strong) {
+        if (strong) {
+            entry = entry_for(strong.get());
+        }
+    }
+
+    intrusive_weak_ptr(const intrusive_weak_ptr& other) : entry(other.entry) {
+        if (entry) {
+            ++entry->weak_refs;
+        }
+    }
+
+    intrusive_weak_ptr(intrusive_weak_ptr&& other) noexcept : entry(std::exchange(other.entry, nullptr)) {}
+
+    ~intrusive_weak_ptr() { release(); }
+
+    intrusive_weak_ptr& operator=(intrusive_weak_ptr other) noexcept {
+        std::swap(entry, other.entry);
+        return *this;
+    }
+
+    bool expired() const { return !entry || !entry->object; }
+
+    // A strong reference, or null if the object is gone.
+    intrusive_ptr<T> lock() const {
+        if (expired()) {
+            return intrusive_ptr<T>();
+        }
+        // Downcast from the RefCounted base recorded in the entry.
+        return intrusive_ptr<T>(const_cast<T*>(static_cast<const T*>(entry->object)));
+    }
+};
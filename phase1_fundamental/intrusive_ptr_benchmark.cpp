@@ -0,0 +1,105 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench_harness.h"
+#include "intrusive_ptr.h"
+
+struct Payload {
+    int values[4] = {1, 2, 3, 4};
+};
+
+struct LocalPayload : RefCounted<LocalCount> {
+    int values[4] = {1, 2, 3, 4};
+};
+
+struct AtomicPayload : RefCounted<AtomicCount> {
+    int values[4] = {1, 2, 3, 4};
+};
+
+class RefCountBenchmark {
+public:
+    static constexpr int COUNT = 10000;
+
+    // Copy, move and destruction storms over COUNT pointers made by `make`.
+    template<typename Ptr, typename Make>
+    static void storms(bench::Suite& suite, const std::string& name, Make make) {
+        std::vector<Ptr> originals;
+        for (int i = 0; i < COUNT; ++i) {
+            originals.push_back(make());
+        }
+        std::vector<Ptr> copies(COUNT);
+        std::vector<Ptr> moved(COUNT);
+
+        // Every copy is an increment, every clear a decrement that isn't the last.
+        auto copy = suite.run(name + " copy+drop", [&] {
+            for (int i = 0; i < COUNT; ++i) {
+                copies[i] = originals[i];
+            }
+            bench::DoNotOptimize(copies.data());
+            for (auto& p : copies) {
+                p = nullptr;
+            }
+        }, COUNT);
+
+        // Moves never touch the count.
+        auto move = suite.run(name + " move there+back", [&] {
+            for (int i = 0; i < COUNT; ++i) {
+                moved[i] = std::move(originals[i]);
+            }
+            bench::DoNotOptimize(moved.data());
+            for (int i = 0; i < COUNT; ++i) {
+                originals[i] = std::move(moved[i]);
+            }
+        }, COUNT);
+
+        // Allocation, first reference, last reference and free.
+        auto destroy = suite.run(name + " create+destroy", [&] {
+            for (int i = 0; i < COUNT; ++i) {
+                copies[i] = make();
+            }
+            bench::DoNotOptimize(copies.data());
+            for (auto& p : copies) {
+                p = nullptr;
+            }
+        }, COUNT);
+
+        rows.push_back(name + "\t" + std::to_string(sizeof(Ptr)) + "\t" + std::to_string(copy.median) +
+                       "\t" + std::to_string(move.median) + "\t" + std::to_string(destroy.median));
+    }
+
+    static std::vector<std::string> rows;
+};
+
+std::vector<std::string> RefCountBenchmark::rows;
+
+static void runAll(bench::Suite& suite, const std::string& phase) {
+    RefCountBenchmark::storms<std::shared_ptr<Payload>>(suite, "shared_ptr(new T)" + phase,
+        [] { return std::shared_ptr<Payload>(new Payload()); });
+    RefCountBenchmark::storms<std::shared_ptr<Payload>>(suite, "make_shared" + phase,
+        [] { return std::make_shared<Payload>(); });
+    RefCountBenchmark::storms<intrusive_ptr<AtomicPayload>>(suite, "intrusive atomic" + phase,
+        [] { return make_intrusive<AtomicPayload>(); });
+    RefCountBenchmark::storms<intrusive_ptr<LocalPayload>>(suite, "intrusive local" + phase,
+        [] { return make_intrusive<LocalPayload>(); });
+}
+
+int main(int argc, char** argv) {
+    bench::Suite suite("intrusive_ptr_benchmark", argc, argv);
+
+    // libstdc++ skips the atomic instructions in shared_ptr while the
+    // process has never started a thread, so measure both states.
+    runAll(suite, " [1 thread]");
+    std::thread([] {}).join();
+    runAll(suite, " [threaded]");
+
+    std::cout << "\nns per pointer (median)\n";
+    std::cout << "design\t\t\t\tbytes\tcopy+drop\tmove x2\t\tcreate+destroy\n";
+    for (const auto& row : RefCountBenchmark::rows) {
+        std::cout << row << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Field-by-field layout report for a struct: offset, size and alignment of
+// each listed field, the padding holes between them, where 64-byte cache
+// lines begin, and fields written by different threads that can land on
+// the same line (false sharing).
+//
+// There is no reflection, so the fields are listed by hand:
+//
+//     layout::Layout stats = LAYOUT_OF(Stats,
+//         LAYOUT_FIELD(Stats, name),
+//         LAYOUT_WRITTEN_BY(Stats, hits, "worker"),
+//         LAYOUT_WRITTEN_BY(Stats, misses, "flusher"));
+//     stats.print(std::cout);
+//
+// Offsets come from offsetof, so the struct should be standard-layout
+// (GCC and Clang accept others with -Winvalid-offsetof). Bytes not
+// covered by a listed field are reported as holes, so list every field
+// for the holes to mean padding.
+//
+// A struct aligned to less than a cache line can start anywhere in one,
+// so for it two fields "may share" a line when less than 64 bytes
+// separate them; with alignas(64) the line of every offset is known.
+namespace layout {
+
+// Every x86-64 and most ARM64 cores; std::hardware_destructive_interference_size
+// is the same value where the library provides it.
+inline constexpr size_t CACHE_LINE = 64;
+
+struct Field {
+    const char* name;
+    size_t offset;
+    size_t size;
+    size_t align;
+    const char* writer;     // thread or role that stores to it; nullptr if none given
+};
+
+struct Hole {
+    size_t offset;
+    size_t size;
+};
+
+struct Conflict {
+    const Field* first;
+    const Field* second;
+    bool certain;           // same line for every placement of the object
+};
+
+class Layout {
+private:
+    std::string type_name;
+    size_t type_size;
+    size_t type_align;
+    std::vector<Field> field_list;
+
+    static size_t line_of(size_t offset) { return offset / CACHE_LINE; }
+    static size_t end_of(const Field& field) { return field.offset + field.size; }
+
+    // Bytes between the end of one range and the start of the other; 0 if
+    // they overlap or touch.
+    static size_t gap(const Field& a, const Field& b) {
+        if (end_of(a) <= b.offset) {
+            return b.offset - end_of(a);
+        }
+        if (end_of(b) <= a.offset) {
+            return a.offset - end_of(b);
+        }
+        return 0;
+    }
+
+public:
+    Layout(const char* name, size_t size, size_t align, std::initializer_list<Field> fields)
+        : type_name(name), type_size(size), type_align(align), field_list(fields) {
+        std::stable_sort(field_list.begin(), field_list.end(),
+                         [](const Field& a, const Field& b) { return a.offset < b.offset; });
+    }
+
+    const std::string& name() const { return type_name; }
+    size_t size() const { return type_size; }
+    size_t align() const { return type_align; }
+    const std::vector<Field>& fields() const { return field_list; }
+    bool line_aligned() const { return type_align >= CACHE_LINE && type_align % CACHE_LINE == 0; }
+
+    // Gaps between listed fields, then tail padding up to sizeof.
+    std::vector<Hole> holes() const {
+        std::vector<Hole> found;
+        size_t covered = 0;
+        for (const Field& field : field_list) {
+            if (field.offset > covered) {
+                found.push_back(Hole{covered, field.offset - covered});
+            }
+            covered = std::max(covered, end_of(field));
+        }
+        if (type_size > covered) {
+            found.push_back(Hole{covered, type_size - covered});
+        }
+        return found;
+    }
+
+    size_t padding() const {
+        size_t total = 0;
+        for (const Hole& hole : holes()) {
+            total += hole.size;
+        }
+        return total;
+    }
+
+    // Lines the object occupies when it starts on a line boundary.
+    size_t cache_lines() const { return (type_size + CACHE_LINE - 1) / CACHE_LINE; }
+
+    // True if the field crosses a line boundary (when the object starts on
+    // one), so a single access may touch two lines.
+    static bool straddles(const Field& field) {
+        return field.size > 0 && line_of(field.offset) != line_of(end_of(field) - 1);
+    }
+
+    // Pairs of fields with different writers that can share a line.
+    std::vector<Conflict> false_sharing() const {
+        std::vector<Conflict> found;
+        for (size_t i = 0; i < field_list.size(); ++i) {
+            for (size_t j = i + 1; j < field_list.size(); ++j) {
+                const Field& a = field_list[i];
+                const Field& b = field_list[j];
+                if (!a.writer || !b.writer || std::strcmp(a.writer, b.writer) == 0) {
+                    continue;
+                }
+                bool certain = line_aligned() && line_of(end_of(a) - 1) >= line_of(b.offset)
+                               && line_of(a.offset) <= line_of(end_of(b) - 1);
+                bool possible = certain || (!line_aligned() && gap(a, b) < CACHE_LINE);
+                if (possible) {
+                    found.push_back(Conflict{&a, &b, certain});
+                }
+            }
+        }
+        return found;
+    }
+
+    void print(std::ostream& out) const {
+        char row[160];
+        std::snprintf(row, sizeof(row), "%s: %zu bytes, align %zu, %zu cache line%s, %zu bytes padding\n",
+                      type_name.c_str(), type_size, type_align, cache_lines(), cache_lines() == 1 ? "" : "s",
+                      padding());
+        out << row;
+        std::snprintf(row, sizeof(row), "  %6s %6s %5s  %-24s %s\n", "offset", "size", "align", "field", "writer");
+        out << row;
+
+        std::vector<Hole> gaps = holes();
+        size_t next_hole = 0;
+        size_t line = SIZE_MAX;
+        auto mark_line = [&](size_t offset) {
+            if (line_of(offset) != line) {
+                line = line_of(offset);
+                std::snprintf(row, sizeof(row), "  ---- line %zu (offset %zu) ----\n", line, line * CACHE_LINE);
+                out << row;
+            }
+        };
+        auto print_holes_before = [&](size_t offset) {
+            while (next_hole < gaps.size() && gaps[next_hole].offset < offset) {
+                mark_line(gaps[next_hole].offset);
+                std::snprintf(row, sizeof(row), "  %6zu %6zu %5s  (padding)\n", gaps[next_hole].offset,
+                              gaps[next_hole].size, "");
+                out << row;
+                ++next_hole;
+            }
+        };
+        for (const Field& field : field_list) {
+            print_holes_before(field.offset);
+            mark_line(field.offset);
+            std::snprintf(row, sizeof(row), "  %6zu %6zu %5zu  %-24s %s%s\n", field.offset, field.size,
+                          field.align, field.name, field.writer ? field.writer : "-",
+                          straddles(field) ? "  (crosses a line)" : "");
+            out << row;
+        }
+        print_holes_before(SIZE_MAX);
+
+        for (const Conflict& conflict : false_sharing()) {
+            std::snprintf(row, sizeof(row), "  FALSE SHARING: %s (%s) and %s (%s) %s\n", conflict.first->name,
+                          conflict.first->writer, conflict.second->name, conflict.second->writer,
+                          conflict.certain ? "share a cache line" : "may share a cache line");
+            out << row;
+        }
+    }
+};
+
+} // namespace layout
+
+#define LAYOUT_FIELD(Type, member) \
+    ::layout::Field{#member, offsetof(Type, member), sizeof(Type::member), alignof(decltype(Type::member)), nullptr}
+
+#define LAYOUT_WRITTEN_BY(Type, member, writer)                                                           \
+    ::layout::Field{#member, offsetof(Type, member), sizeof(Type::member), alignof(decltype(Type::member)), \
+                    writer}
+
+#define LAYOUT_OF(Type, ...) ::layout::Layout(#Type, sizeof(Type), alignof(Type), {__VA_ARGS__})
@@ -2,6 +2,14 @@
 #include <memory>
 #include <exception>
 
+#include "file_writer.h"
+
+// Build with -O0 -rdynamic -DHEAP_PROFILER (at -O1 and up GCC may elide the
+// new/delete pairs below) and run with HEAP_PROFILE_RATE=1 to sample every
+// allocation; at exit the heap profiler writes
+// heap_profile.{inuse,alloc}.collapsed for flamegraph.pl.
+#include "heap_profiler.h"
+
 class LeakDemonstration {
 public:
     // Leak Pattern 1: Simple forget to delete
@@ -63,13 +71,12 @@ public:
     
     // Leak Pattern 4: Resource leak (file handles)
     void resourceLeak() {
-        FILE* file = fopen("temp.txt", "w");
+        FileHandle file("temp.txt", "w");
         if (file) {
-            fprintf(file, "Some data");
-            // Oops! Forgot to fclose(file);
-            // File handle leaked!
+            fprintf(file.get(), "Some data");
+            // No fclose(file) needed: FileHandle closes it on every path,
+            // and never calls fclose(nullptr) when fopen failed
         }
-		fclose(file);
     }
 };
 
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "epoch_reclaimer.h"
+
+// Sorted set of ints as a lock-free singly linked list (Harris-Michael).
+//
+// The Node from leak_creation.cpp with the prev pointer dropped and next
+// made atomic. Removal is two steps: set the low bit of the victim's next
+// link (logical delete, after which no insert can attach behind it), then
+// swing the predecessor's link past it. Any thread that walks past a
+// marked node helps unlink it, and whichever thread's CAS unlinks a node
+// retires it to the EpochReclaimer instead of deleting it, so concurrent
+// readers that still hold it never touch freed memory.
+//
+// contains() and for_each() take no lock and never write shared memory
+// beyond the reader's own epoch slot.
+class LockFreeList {
+public:
+    struct Node {
+        int value;
+        std::atomic<uintptr_t> next;    // successor, | MARK once this node is removed
+
+        explicit Node(int v) : value(v), next(0) {}
+    };
+
+private:
+    static constexpr uintptr_t MARK = 1;
+
+    std::atomic<uintptr_t> head{0};
+    std::atomic<size_t> count{0};
+    EpochReclaimer& reclaimer;
+
+    static Node* node_of(uintptr_t link) { return reinterpret_cast<Node*>(link & ~MARK); }
+    static bool is_marked(uintptr_t link) { return (link & MARK) != 0; }
+    static uintptr_t link_to(Node* node) { return reinterpret_cast<uintptr_t>(node); }
+
+    // The link that points at the first node >= key, and that node.
+    struct Position {
+        std::atomic<uintptr_t>* prev;
+        Node* curr;
+    };
+
+    // Unlinks (and retires) every marked node it passes. Caller holds a guard.
+    Position find(int key) {
+    retry:
+        std::atomic<uintptr_t>* prev = &head;
+        Node* curr = node_of(prev->load(std::memory_order_acquire));
+        while (curr) {
+            uintptr_t next = curr->next.load(std::memory_order_acquire);
+            if (is_marked(next)) {
+                uintptr_t expected = link_to(curr);
+                // Fails if prev changed or prev's own node was marked meanwhile.
+                if (!prev->compare_exchange_strong(expected, next & ~MARK, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+                    goto retry;
+                }
+                reclaimer.retire(curr);
+                curr = node_of(next);
+                continue;
+            }
+            if (curr->value >= key) {
+                break;
+            }
+            prev = &curr->next;
+            curr = node_of(next);
+        }
+        return Position{prev, curr};
+    }
+
+public:
+    explicit LockFreeList(EpochReclaimer& domain = EpochReclaimer::instance()) : reclaimer(domain) {}
+
+    // Only when no other thread is using the list.
+    ~LockFreeList() {
+        Node* node = node_of(head.load(std::memory_order_acquire));
+        while (node) {
+            Node* next = node_of(node->next.load(std::memory_order_relaxed));
+            delete node;
+            node = next;
+        }
+    }
+
+    LockFreeList(const LockFreeList&) = delete;
+    LockFreeList& operator=(const LockFreeList&) = delete;
+
+    // False if the value was already present.
+    bool insert(int value) {
+        auto guard = reclaimer.pin();
+        Node* node = nullptr;
+        while (true) {
+            Position pos = find(value);
+            if (pos.curr && pos.curr->value == value) {
+                delete node;    // never published
+                return false;
+            }
+            if (!node) {
+                node = new Node(value);
+            }
+            node->next.store(link_to(pos.curr), std::memory_order_relaxed);
+            uintptr_t expected = link_to(pos.curr);
+            if (pos.prev->compare_exchange_strong(expected, link_to(node), std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+                count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    // False if the value was not present.
+    bool remove(int value) {
+        auto guard = reclaimer.pin();
+        while (true) {
+            Position pos = find(value);
+            if (!pos.curr || pos.curr->value != value) {
+                return false;
+            }
+            uintptr_t next = pos.curr->next.load(std::memory_order_acquire);
+            if (is_marked(next)) {
+                continue;   // another remover got there first; find() will unlink it
+            }
+            if (!pos.curr->next.compare_exchange_strong(next, next | MARK, std::memory_order_acq_rel,
+                                                        std::memory_order_relaxed)) {
+                continue;
+            }
+            count.fetch_sub(1, std::memory_order_relaxed);
+            uintptr_t expected = link_to(pos.curr);
+            if (pos.prev->compare_exchange_strong(expected, next, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed)) {
+                reclaimer.retire(pos.curr);
+            } else {
+                find(value);    // let the helping path unlink it
+            }
+            return true;
+        }
+    }
+
+    bool contains(int value) {
+        auto guard = reclaimer.pin();
+        Node* curr = node_of(head.load(std::memory_order_acquire));
+        while (curr && curr->value < value) {
+            curr = node_of(curr->next.load(std::memory_order_acquire));
+        }
+        return curr && curr->value == value && !is_marked(curr->next.load(std::memory_order_acquire));
+    }
+
+    // Calls f(value) for each present value in ascending order. Values
+    // inserted or removed during the walk may or may not be seen.
+    template<typename F>
+    void for_each(F&& f) {
+        auto guard = reclaimer.pin();
+        for (Node* curr = node_of(head.load(std::memory_order_acquire)); curr;) {
+            uintptr_t next = curr->next.load(std::memory_order_acquire);
+            if (!is_marked(next)) {
+                f(curr->value);
+            }
+            curr = node_of(next);
+        }
+    }
+
+    // Exact when quiescent, approximate under concurrent updates.
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+};
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "lockfree_list.h"
+
+// The same sorted singly linked list behind a reader/writer lock: readers
+// share the lock, writers take it exclusively and delete nodes directly.
+class SharedMutexList {
+private:
+    struct Node {
+        int value;
+        Node* next;
+    };
+
+    Node* head = nullptr;
+    mutable std::shared_mutex mutex;
+
+public:
+    ~SharedMutexList() {
+        while (head) {
+            Node* next = head->next;
+            delete head;
+            head = next;
+        }
+    }
+
+    bool insert(int value) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        Node** link = &head;
+        while (*link && (*link)->value < value) {
+            link = &(*link)->next;
+        }
+        if (*link && (*link)->value == value) {
+            return false;
+        }
+        *link = new Node{value, *link};
+        return true;
+    }
+
+    bool remove(int value) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        Node** link = &head;
+        while (*link && (*link)->value < value) {
+            link = &(*link)->next;
+        }
+        if (!*link || (*link)->value != value) {
+            return false;
+        }
+        Node* victim = *link;
+        *link = victim->next;
+        delete victim;
+        return true;
+    }
+
+    bool contains(int value) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        const Node* node = head;
+        while (node && node->value < value) {
+            node = node->next;
+        }
+        return node && node->value == value;
+    }
+};
+
+class ReadMostlyBenchmark {
+public:
+    static constexpr int KEY_RANGE = 1024;
+    static constexpr int OPS_PER_THREAD = 20000;
+
+    // Half the key range present, so lookups hit about half the time.
+    template<typename List>
+    static void prefill(List& list) {
+        for (int key = 0; key < KEY_RANGE; key += 2) {
+            list.insert(key);
+        }
+    }
+
+    // Each thread does OPS_PER_THREAD operations, `read_percent` of them
+    // lookups and the rest an even mix of inserts and removes.
+    template<typename List>
+    static void run(List& list, int threads, int read_percent) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(t + 1);
+                long hits = 0;
+                for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                    uint32_t r = rng();
+                    int key = static_cast<int>(r % KEY_RANGE);
+                    int dice = static_cast<int>((r >> 10) % 100);
+                    if (dice < read_percent) {
+                        hits += list.contains(key);
+                    } else if (dice & 1) {
+                        list.insert(key);
+                    } else {
+                        list.remove(key);
+                    }
+                }
+                bench::DoNotOptimize(hits);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    int max_threads = static_cast<int>(std::max(4u, std::thread::hardware_concurrency()));
+    if (argc > 1 && argv[1][0] != '-') {
+        max_threads = std::atoi(argv[1]);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 7;
+    bench::Suite suite("lockfree_list_benchmark", argc, argv, options);
+
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << "Sorted list of ints, keys 0.." << ReadMostlyBenchmark::KEY_RANGE - 1
+              << ", half present\n";
+
+    std::vector<std::string> summary;
+    for (int read_percent : {100, 99, 90}) {
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            const size_t ops = static_cast<size_t>(threads) * ReadMostlyBenchmark::OPS_PER_THREAD;
+            const std::string suffix = " reads=" + std::to_string(read_percent) + "% threads=" +
+                                       std::to_string(threads);
+
+            LockFreeList lock_free;
+            ReadMostlyBenchmark::prefill(lock_free);
+            auto lock_free_result = suite.run_once("LockFreeList" + suffix, [&] {
+                ReadMostlyBenchmark::run(lock_free, threads, read_percent);
+            }, ops);
+
+            SharedMutexList locked;
+            ReadMostlyBenchmark::prefill(locked);
+            auto locked_result = suite.run_once("shared_mutex list" + suffix, [&] {
+                ReadMostlyBenchmark::run(locked, threads, read_percent);
+            }, ops);
+
+            summary.push_back(std::to_string(read_percent) + "%\t" + std::to_string(threads) + "\t " +
+                              std::to_string(lock_free_result.ops_per_second() / 1e6) + "\t " +
+                              std::to_string(locked_result.ops_per_second() / 1e6) + "\t" +
+                              std::to_string(lock_free_result.ops_per_second() /
+                                             locked_result.ops_per_second()) + "x");
+        }
+    }
+
+    std::cout << "\nreads\tthreads  lock-free M/s  shared_mutex M/s  ratio\n";
+    for (const auto& line : summary) {
+        std::cout << line << "\n";
+    }
+    EpochReclaimer::instance().drain();
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "lockfree_list.h"
+
+// Readers walk the list while writers insert and remove random keys from a
+// small range, so nodes are unlinked and reclaimed under the readers' feet.
+// Meant to run under the sanitizers:
+//
+//   g++ -std=c++17 -g -O1 -fsanitize=thread -pthread lockfree_list_stress.cpp -o lockfree_list_tsan
+//   g++ -std=c++17 -g -O1 -fsanitize=address -pthread lockfree_list_stress.cpp -o lockfree_list_asan
+//
+// ASan catches a reader touching a reclaimed node, TSan a missing
+// happens-before between unlink, retire and free. test_lockfree_list.sh
+// builds and runs both. Optional args: readers writers ops_per_writer.
+
+static constexpr int KEY_RANGE = 512;
+
+int main(int argc, char** argv) {
+    int readers = argc > 1 ? std::atoi(argv[1]) : 4;
+    int writers = argc > 2 ? std::atoi(argv[2]) : 4;
+    int ops = argc > 3 ? std::atoi(argv[3]) : 50000;
+
+    LockFreeList list;
+    std::atomic<bool> done{false};
+    std::atomic<long> net_inserts{0};
+    std::atomic<int> failures{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            std::mt19937 rng(w + 1);
+            long net = 0;
+            for (int i = 0; i < ops; ++i) {
+                int key = static_cast<int>(rng() % KEY_RANGE);
+                if (rng() & 1) {
+                    net += list.insert(key);
+                } else {
+                    net -= list.remove(key);
+                }
+            }
+            net_inserts.fetch_add(net);
+        });
+    }
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            std::mt19937 rng(1000 + r);
+            long walks = 0;
+            while (!done.load(std::memory_order_relaxed) || walks == 0) {
+                // A walk must always see strictly ascending values in range.
+                int last = -1;
+                bool ordered = true;
+                list.for_each([&](int value) {
+                    ordered = ordered && value > last && value < KEY_RANGE;
+                    last = value;
+                });
+                if (!ordered) {
+                    failures.fetch_add(1);
+                }
+                for (int i = 0; i < 64; ++i) {
+                    list.contains(static_cast<int>(rng() % KEY_RANGE));
+                }
+                ++walks;
+            }
+        });
+    }
+
+    for (int w = 0; w < writers; ++w) {
+        threads[w].join();
+    }
+    done = true;
+    for (size_t t = writers; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+
+    // Quiescent now: the list must match what the writers reported.
+    size_t walked = 0;
+    int last = -1;
+    list.for_each([&](int value) {
+        if (value <= last) {
+            failures.fetch_add(1);
+        }
+        last = value;
+        ++walked;
+    });
+    if (walked != list.size() || static_cast<long>(walked) != net_inserts.load()) {
+        std::cerr << "size mismatch: walked " << walked << ", size() " << list.size()
+                  << ", net inserts " << net_inserts.load() << "\n";
+        failures.fetch_add(1);
+    }
+    if (failures.load() != 0) {
+        std::cerr << "FAILED: " << failures.load() << " inconsistent observation(s)\n";
+        return 1;
+    }
+
+    EpochReclaimer::instance().drain();
+    std::cout << "ok: " << readers << " readers, " << writers << " writers x " << ops << " ops, "
+              << walked << " keys left, epoch " << EpochReclaimer::instance().epoch() << "\n";
+    return 0;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+// A file mapped into memory, unmapped on destruction.
+//
+// Reading through the mapping copies nothing: the page cache pages are
+// the bytes view() and lines() hand out, where ifstream + getline copies
+// every byte twice (kernel to stream buffer, stream buffer to string).
+// Views stay valid as long as the MappedFile does.
+//
+// ReadWrite maps the file shared, so stores reach the file; sync() forces
+// them to disk. Mapping fails with std::system_error. An empty file maps
+// to an empty view (mmap refuses zero-length mappings).
+class MappedFile {
+public:
+    enum class Access { ReadOnly, ReadWrite };
+    enum class Advice { Normal, Sequential, Random, WillNeed, DontNeed };
+
+    // Forward iterator over the lines of a buffer, without the '\n'. A
+    // final line with no newline is still a line; a trailing newline does
+    // not start an empty one (the same lines getline would produce).
+    class LineIterator {
+    private:
+        const char* pos = nullptr;      // start of the current line
+        const char* end = nullptr;
+        const char* line_end = nullptr;
+
+        void find_end() {
+            const void* newline = pos == end ? nullptr : std::memchr(pos, '\n', end - pos);
+            line_end = newline ? static_cast<const char*>(newline) : end;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = std::string_view;
+
+        LineIterator() = default;
+        LineIterator(const char* begin, const char* stop) : pos(begin), end(stop) {
+            if (pos != end) {
+                find_end();
+            } else {
+                pos = nullptr;
+            }
+        }
+
+        std::string_view operator*() const { return std::string_view(pos, line_end - pos); }
+
+        LineIterator& operator++() {
+            if (line_end == end || line_end + 1 == end) {
+                pos = nullptr;          // past the last line
+            } else {
+                pos = line_end + 1;
+                find_end();
+            }
+            return *this;
+        }
+
+        LineIterator operator++(int) {
+            LineIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        friend bool operator==(const LineIterator& a, const LineIterator& b) { return a.pos == b.pos; }
+        friend bool operator!=(const LineIterator& a, const LineIterator& b) { return a.pos != b.pos; }
+    };
+
+    struct Lines {
+        const char* first;
+        const char* last;
+
+        LineIterator begin() const { return LineIterator(first, last); }
+        LineIterator end() const { return LineIterator(); }
+    };
+
+private:
+    char* base = nullptr;
+    size_t length = 0;
+    Access access = Access::ReadOnly;
+
+    static std::system_error error(const char* what, const std::string& path) {
+        return std::system_error(errno, std::generic_category(), std::string(what) + " " + path);
+    }
+
+    void map(int fd, const std::string& path) {
+        if (length == 0) {
+            return;
+        }
+        int protection = access == Access::ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* mapped = mmap(nullptr, length, protection, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            throw error("mmap", path);
+        }
+        base = static_cast<char*>(mapped);
+    }
+
+    void unmap() {
+        if (base) {
+            munmap(base, length);
+            base = nullptr;
+            length = 0;
+        }
+    }
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path, Access mode = Access::ReadOnly) : access(mode) {
+        int fd = open(path.c_str(), mode == Access::ReadWrite ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            throw error("open", path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            throw error("fstat", path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        try {
+            map(fd, path);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);      // the mapping keeps its own reference to the file
+    }
+
+    // Creates (or truncates) `path` to `size` bytes and maps it read-write.
+    static MappedFile create(const std::string& path, size_t size) {
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw error("open", path);
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            int saved = errno;
+            close(fd);
+            errno = saved;
+            throw error("ftruncate", path);
+        }
+        MappedFile file;
+        file.access = Access::ReadWrite;
+        file.length = size;
+        try {
+            file.map(fd, path);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+        return file;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    MappedFile(MappedFile&& other) noexcept
+        : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)),
+          access(other.access) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            base = std::exchange(other.base, nullptr);
+            length = std::exchange(other.length, 0);
+            access = other.access;
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Tells the kernel how the range will be read: Sequential doubles
+    // readahead and drops pages behind the reader, Random turns readahead
+    // off, WillNeed starts reading now, DontNeed lets the pages go. False
+    // if the kernel rejected the hint.
+    bool advise(Advice advice, size_t offset = 0, size_t size = SIZE_MAX) {
+        if (!base || offset >= length) {
+            return false;
+        }
+        // madvise wants a page-aligned start.
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t start = offset / page * page;
+        size_t stop = size > length - offset ? length : offset + size;
+        int flag = advice == Advice::Sequential ? MADV_SEQUENTIAL
+                 : advice == Advice::Random     ? MADV_RANDOM
+                 : advice == Advice::WillNeed   ? MADV_WILLNEED
+                 : advice == Advice::DontNeed   ? MADV_DONTNEED
+                 : MADV_NORMAL;
+        return madvise(base + start, stop - start, flag) == 0;
+    }
+
+    // Writes dirty pages of a ReadWrite mapping back to the file.
+    bool sync() { return !base || msync(base, length, MS_SYNC) == 0; }
+
+    const char* data() const { return base; }
+    // Writable bytes, or nullptr for a ReadOnly mapping.
+    char* mutable_data() { return access == Access::ReadWrite ? base : nullptr; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    bool writable() const { return access == Access::ReadWrite; }
+
+    std::string_view view() const { return std::string_view(base, length); }
+    Lines lines() const { return Lines{base, base + length}; }
+};
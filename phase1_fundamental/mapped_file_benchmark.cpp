@@ -0,0 +1,169 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_harness.h"
+#include "mapped_file.h"
+
+// Line scanning over a large generated text file: ifstream + getline (what
+// testResourceCleanup did), fread into a reused buffer, and MappedFile's
+// string_view lines with and without a sequential-access hint.
+//
+// Every scanner returns the same line count and byte total, so they do
+// the same work. "warm" runs read from the page cache; "cold" runs first
+// evict the file with posix_fadvise(DONTNEED), so they include disk reads.
+class LineScanBenchmark {
+public:
+    struct Totals {
+        size_t lines = 0;
+        size_t bytes = 0;
+
+        bool operator==(const Totals& other) const { return lines == other.lines && bytes == other.bytes; }
+    };
+
+    static void generate(const std::string& path, size_t bytes) {
+        std::ofstream out(path, std::ios::binary);
+        std::mt19937 rng(7);
+        std::string line;
+        size_t written = 0;
+        while (written < bytes) {
+            // 10..120 printable characters, a log-line-ish spread
+            line.assign(10 + rng() % 111, ' ');
+            for (char& c : line) {
+                c = static_cast<char>('a' + rng() % 26);
+            }
+            line += '\n';
+            out.write(line.data(), line.size());
+            written += line.size();
+        }
+    }
+
+    static void evict(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fdatasync(fd);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            close(fd);
+        }
+    }
+
+    static Totals withGetline(const std::string& path) {
+        Totals totals;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            ++totals.lines;
+            totals.bytes += line.size();
+        }
+        return totals;
+    }
+
+    // 1 MiB reads; a line split across two reads is counted once.
+    static Totals withFread(const std::string& path) {
+        Totals totals;
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return totals;
+        }
+        std::vector<char> buffer(1 << 20);
+        bool partial = false;       // a line has started but not ended
+        size_t read;
+        while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+            const char* pos = buffer.data();
+            const char* end = pos + read;
+            while (pos < end) {
+                const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+                const char* line_end = newline ? newline : end;
+                totals.bytes += line_end - pos;
+                if (newline) {
+                    ++totals.lines;
+                    partial = false;
+                    pos = newline + 1;
+                } else {
+                    partial = true;
+                    pos = end;
+                }
+            }
+        }
+        totals.lines += partial;
+        std::fclose(file);
+        return totals;
+    }
+
+    static Totals withMapping(const std::string& path, bool sequential) {
+        Totals totals;
+        MappedFile file(path);
+        if (sequential) {
+            file.advise(MappedFile::Advice::Sequential);
+        }
+        for (std::string_view line : file.lines()) {
+            ++totals.lines;
+            totals.bytes += line.size();
+        }
+        return totals;
+    }
+};
+
+int main(int argc, char** argv) {
+    size_t mib = 1024;
+    std::string path = "/tmp/mapped_file_benchmark.txt";
+    if (argc > 1 && argv[1][0] != '-') {
+        mib = std::strtoul(argv[1], nullptr, 10);
+    }
+    if (argc > 2 && argv[2][0] != '-') {
+        path = argv[2];
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 3;
+    bench::Suite suite("mapped_file_benchmark", argc, argv, options);
+
+    std::cout << "Generating " << mib << " MiB of lines in " << path << "...\n";
+    LineScanBenchmark::generate(path, mib << 20);
+    const size_t bytes = mib << 20;
+
+    struct Scanner {
+        const char* name;
+        LineScanBenchmark::Totals (*scan)(const std::string&);
+    };
+    const Scanner scanners[] = {
+        {"ifstream + getline", LineScanBenchmark::withGetline},
+        {"fread 1 MiB + memchr", LineScanBenchmark::withFread},
+        {"MappedFile lines", [](const std::string& p) { return LineScanBenchmark::withMapping(p, false); }},
+        {"MappedFile lines, sequential", [](const std::string& p) { return LineScanBenchmark::withMapping(p, true); }},
+    };
+
+    LineScanBenchmark::Totals expected = LineScanBenchmark::withGetline(path);
+    std::printf("%zu lines\n", expected.lines);
+
+    std::vector<std::string> summary;
+    for (bool cold : {false, true}) {
+        for (const Scanner& scanner : scanners) {
+            LineScanBenchmark::Totals totals;
+            auto result = suite.run_once(std::string(scanner.name) + (cold ? " cold" : " warm"), [&] {
+                if (cold) {
+                    LineScanBenchmark::evict(path);
+                }
+                totals = scanner.scan(path);
+            }, bytes);
+            char row[128];
+            std::snprintf(row, sizeof(row), "%-30s %-5s %8.2f GB/s%s", scanner.name, cold ? "cold" : "warm",
+                          1.0 / result.median, totals == expected ? "" : "  (MISMATCH)");
+            summary.push_back(row);
+        }
+    }
+
+    std::printf("\nline scan over %zu MiB\n", mib);
+    for (const auto& row : summary) {
+        std::printf("%s\n", row.c_str());
+    }
+    std::remove(path.c_str());
+    return 0;
+}
@@ -1,6 +1,26 @@
+#include <cstdio>
+
+#include "stack_executor.h"
+
+// The 10 MB array below overflows an 8 MB default stack (and the 1 MB one
+// on Windows). Run on a 16 MB StackExecutor stack it fits, and the
+// executor reports how deep it went.
 int main() {
     const int SIZE = 10 * 1024 * 1024 / sizeof(int); // 10MB worth of ints
-    int huge_array[SIZE];  // Stack overflow on Windows, might work on Linux
-    huge_array[0] = 42;    // If it doesn't crash immediately
+    StackExecutor executor(16 * 1024 * 1024);
+    int first = executor.run([] {
+        int huge_array[SIZE];
+        for (int i = 0; i < SIZE; i += 1024) {     // touch every page
+            huge_array[i] = i;
+        }
+        huge_array[0] = 42;
+        volatile int* escaped = huge_array;
+        return escaped[0];
+    });
+
+    const StackExecutor::Usage& usage = executor.usage();
+    std::printf("huge_array[0] = %d\n", first);
+    std::printf("stack: %zu KiB + %zu KiB guard, high-water mark %zu KiB, %zu KiB left\n",
+                usage.size >> 10, usage.guard >> 10, usage.used >> 10, usage.remaining() >> 10);
     return 0;
-}
\ No newline at end of file
+}
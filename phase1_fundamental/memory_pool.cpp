@@ -1,57 +1,42 @@
 #include <iostream>
 #include <vector>
 
-template<typename T>
-class SimplePool {
-private:
-    static constexpr size_t POOL_SIZE = 1024;
-    std::vector<T> pool;
-    std::vector<T*> available;
-    
-public:
-    SimplePool() : pool(POOL_SIZE) {
-        // Initialize all slots as available
-        for (auto& item : pool) {
-            available.push_back(&item);
-        }
-    }
-    
-    T* allocate() {
-        if (available.empty()) {
-            throw std::bad_alloc();
-        }
-        T* ptr = available.back();
-        available.pop_back();
-        return ptr;
-    }
-    
-    void deallocate(T* ptr) {
-        available.push_back(ptr);
-    }
-    
-    size_t available_count() const {
-        return available.size();
-    }
-};
+#include "simple_pool.h"
 
 // Usage example
 int main() {
     SimplePool<int> pool;
-    
+
     // Fast allocation from pool
     int* p1 = pool.allocate();
     *p1 = 42;
-    
+
     int* p2 = pool.allocate();
     *p2 = 100;
-    
+
     std::cout << "Available slots: " << pool.available_count() << "\n";
-    
+
     // Return to pool (no actual heap deallocation)
     pool.deallocate(p1);
     pool.deallocate(p2);
-    
+
     std::cout << "Available slots: " << pool.available_count() << "\n";
-    
+
+    // Growing past the first chunk adds a new chunk instead of throwing,
+    // and objects already handed out stay where they are.
+    std::vector<int*> held;
+    for (int i = 0; i < 3000; ++i) {
+        int* p = pool.allocate();
+        *p = i;
+        held.push_back(p);
+    }
+    std::cout << "Capacity after 3000 allocations: " << pool.capacity() << "\n";
+    std::cout << "First object still holds: " << *held.front() << "\n";
+
+    for (int* p : held) {
+        pool.deallocate(p);
+    }
+    std::cout << "Available slots: " << pool.available_count() << "\n";
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <initializer_list>
+#include <malloc.h>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// What the process costs the OS, sampled over time.
+//
+// A Sampler thread records a Sample every interval: virtual size and RSS
+// from /proc/self/statm, anonymous/file RSS and the RSS high-water mark
+// from /proc/self/status, minor and major page faults from getrusage,
+// and malloc's view of the heap from mallinfo2. mark() records one more
+// sample immediately, labelled ("testMemoryUsagePattern begin"), from any
+// thread; Marker does a begin/end pair for a scope. The timeline exports
+// as CSV or JSON.
+//
+// Samples go through a bounded lock-free ring (Vyukov's MPMC queue), so a
+// thread placing a marker never waits on the exporter; the sampler thread
+// moves them into the timeline every tick. If markers outrun it, the ring
+// drops samples and dropped() counts them.
+//
+// Define MEMORY_TELEMETRY (or pass -DMEMORY_TELEMETRY) to start a
+// process-wide sampler before main and write its timeline at exit to
+// $MEMORY_TELEMETRY (default memory_telemetry.csv; a .json name writes
+// JSON), every $MEMORY_TELEMETRY_INTERVAL_MS milliseconds (default 10).
+// Markers go to that sampler, and are no-ops when it is not compiled in.
+namespace memory_telemetry {
+
+#ifdef MEMORY_TELEMETRY
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+struct Sample {
+    static constexpr size_t LABEL_BYTES = 64;
+
+    uint64_t time_ns = 0;           // since the sampler started
+    uint64_t vm_size = 0;           // bytes
+    uint64_t rss = 0;
+    uint64_t rss_anon = 0;
+    uint64_t rss_file = 0;
+    uint64_t peak_rss = 0;          // VmHWM
+    uint64_t minor_faults = 0;      // cumulative
+    uint64_t major_faults = 0;
+    uint64_t heap_in_use = 0;       // mallinfo2: allocated chunks, including mmapped ones
+    uint64_t heap_free = 0;         // free chunks malloc holds on to
+    uint64_t heap_mapped = 0;       // in separate mmap regions
+    char label[LABEL_BYTES] = {};   // empty for periodic samples
+};
+
+namespace detail {
+
+// Reads a small /proc file into `buffer` without allocating.
+inline size_t read_proc(const char* path, char* buffer, size_t size) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    size_t used = 0;
+    ssize_t got;
+    while (used + 1 < size && (got = ::read(fd, buffer + used, size - 1 - used)) > 0) {
+        used += static_cast<size_t>(got);
+    }
+    ::close(fd);
+    buffer[used] = '\0';
+    return used;
+}
+
+// "Key:   1234 kB" in /proc/self/status, in bytes.
+inline uint64_t status_kb(const char* status, const char* key) {
+    const char* line = std::strstr(status, key);
+    return line ? std::strtoull(line + std::strlen(key), nullptr, 10) * 1024 : 0;
+}
+
+} // namespace detail
+
+// The process's memory state now. Does not allocate.
+inline Sample snapshot() {
+    Sample sample;
+    static const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    char buffer[2048];
+    if (detail::read_proc("/proc/self/statm", buffer, sizeof(buffer))) {
+        char* pos = buffer;
+        sample.vm_size = std::strtoull(pos, &pos, 10) * page;
+        sample.rss = std::strtoull(pos, &pos, 10) * page;
+    }
+    if (detail::read_proc("/proc/self/status", buffer, sizeof(buffer))) {
+        sample.peak_rss = detail::status_kb(buffer, "VmHWM:");
+        sample.rss_anon = detail::status_kb(buffer, "RssAnon:");
+        sample.rss_file = detail::status_kb(buffer, "RssFile:");
+    }
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        sample.minor_faults = static_cast<uint64_t>(usage.ru_minflt);
+        sample.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 heap = mallinfo2();
+    sample.heap_in_use = heap.uordblks + heap.hblkhd;
+    sample.heap_free = heap.fordblks;
+    sample.heap_mapped = heap.hblkhd;
+#endif
+    return sample;
+}
+
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov's): each cell
+// carries a sequence number telling producers and consumers whose turn it
+// is, so push and pop are one CAS on their own index.
+template<typename T>
+class Ring {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail{0};    // next push
+    alignas(64) std::atomic<size_t> head{0};    // next pop
+
+public:
+    // Capacity is rounded up to a power of two.
+    explicit Ring(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    // False if the ring is full.
+    bool push(const T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // False if the ring is empty.
+    bool pop(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t capacity() const { return mask + 1; }
+};
+
+class Sampler {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::chrono::milliseconds interval;
+    Clock::time_point started = Clock::now();
+    Ring<Sample> ring;
+    std::atomic<size_t> dropped_samples{0};
+
+    std::mutex mutex;               // guards everything below
+    std::condition_variable wake;
+    std::vector<Sample> samples;
+    bool running = false;
+    std::thread thread;
+
+    void push(Sample& sample) {
+        sample.time_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count());
+        if (!ring.push(sample)) {
+            dropped_samples.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Moves everything in the ring to the timeline; caller holds `mutex`.
+    void drain() {
+        Sample sample;
+        while (ring.pop(sample)) {
+            samples.push_back(sample);
+        }
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            lock.unlock();
+            Sample sample = snapshot();
+            push(sample);
+            lock.lock();
+            drain();
+            wake.wait_for(lock, interval, [this] { return !running; });
+        }
+    }
+
+    static std::string label_csv(const char* label) {
+        std::string quoted = "\"";
+        for (const char* c = label; *c; ++c) {
+            quoted += *c == '"' ? "\"\"" : std::string(1, *c);
+        }
+        return quoted + "\"";
+    }
+
+    static std::string label_json(const char* label) {
+        std::string escaped;
+        for (const char* c = label; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                escaped += '\\';
+            }
+            escaped += static_cast<unsigned char>(*c) < 0x20 ? ' ' : *c;
+        }
+        return escaped;
+    }
+
+public:
+    explicit Sampler(std::chrono::milliseconds every = std::chrono::milliseconds(10), size_t ring_capacity = 4096)
+        : interval(every), ring(ring_capacity) {}
+
+    ~Sampler() { stop(); }
+
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    void start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return;
+        }
+        running = true;
+        thread = std::thread([this] { loop(); });
+    }
+
+    // Takes a last sample and stops the thread; the timeline is kept.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                return;
+            }
+            running = false;
+        }
+        wake.notify_all();
+        thread.join();
+        Sample last = snapshot();
+        push(last);
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+    }
+
+    // Records a sample now, labelled `label` + `suffix` (truncated to fit).
+    void mark(const char* label, const char* suffix = "") {
+        Sample sample = snapshot();
+        size_t used = 0;
+        for (const char* part : {label, suffix}) {
+            size_t length = std::min(std::strlen(part), sizeof(sample.label) - 1 - used);
+            std::memcpy(sample.label + used, part, length);
+            used += length;
+        }
+        push(sample);
+    }
+
+    // Everything recorded so far, oldest first.
+    std::vector<Sample> timeline() {
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+        std::vector<Sample> ordered = samples;
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [](const Sample& a, const Sample& b) { return a.time_ns < b.time_ns; });
+        return ordered;
+    }
+
+    size_t dropped() const { return dropped_samples.load(std::memory_order_relaxed); }
+
+    // Sizes in KiB, time in milliseconds.
+    void write_csv(std::ostream& out) {
+        out << "time_ms,label,vm_size_kb,rss_kb,rss_anon_kb,rss_file_kb,peak_rss_kb,"
+               "minor_faults,major_faults,heap_in_use_kb,heap_free_kb,heap_mapped_kb\n";
+        for (const Sample& s : timeline()) {
+            char row[256];
+            std::snprintf(row, sizeof(row), "%.3f,%s,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                          static_cast<double>(s.time_ns) / 1e6, label_csv(s.label).c_str(),
+                          static_cast<unsigned long long>(s.vm_size >> 10),
+                          static_cast<unsigned long long>(s.rss >> 10),
+                          static_cast<unsigned long long>(s.rss_anon >> 10),
+                          static_cast<unsigned long long>(s.rss_file >> 10),
+                          static_cast<unsigned long long>(s.peak_rss >> 10),
+                          static_cast<unsigned long long>(s.minor_faults),
+                          static_cast<unsigned long long>(s.major_faults),
+                          static_cast<unsigned long long>(s.heap_in_use >> 10),
+                          static_cast<unsigned long long>(s.heap_free >> 10),
+                          static_cast<unsigned long long>(s.heap_mapped >> 10));
+            out << row;
+        }
+    }
+
+    void write_json(std::ostream& out) {
+        std::vector<Sample> all = timeline();
+        out << "{\"unit\": \"KiB\", \"dropped\": " << dropped() << ", \"samples\": [";
+        for (size_t i = 0; i < all.size(); ++i) {
+            const Sample& s = all[i];
+            char row[384];
+            std::snprintf(row, sizeof(row),
+                          "{\"time_ms\": %.3f, \"label\": \"%s\", \"vm_size\": %llu, \"rss\": %llu, "
+                          "\"rss_anon\": %llu, \"rss_file\": %llu, \"peak_rss\": %llu, \"minor_faults\": %llu, "
+                          "\"major_faults\": %llu, \"heap_in_use\": %llu, \"heap_free\": %llu, "
+                          "\"heap_mapped\": %llu}",
+                          static_cast<double>(s.time_ns) / 1e6, label_json(s.label).c_str(),
+                          static_cast<unsigned long long>(s.vm_size >> 10),
+                          static_cast<unsigned long long>(s.rss >> 10),
+                          static_cast<unsigned long long>(s.rss_anon >> 10),
+                          static_cast<unsigned long long>(s.rss_file >> 10),
+                          static_cast<unsigned long long>(s.peak_rss >> 10),
+                          static_cast<unsigned long long>(s.minor_faults),
+                          static_cast<unsigned long long>(s.major_faults),
+                          static_cast<unsigned long long>(s.heap_in_use >> 10),
+                          static_cast<unsigned long long>(s.heap_free >> 10),
+                          static_cast<unsigned long long>(s.heap_mapped >> 10));
+            out << (i ? ",\n  " : "\n  ") << row;
+        }
+        out << "\n]}\n";
+    }
+
+    // JSON if `path` ends in .json, CSV otherwise.
+    bool write(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        if (json) {
+            write_json(out);
+        } else {
+            write_csv(out);
+        }
+        return static_cast<bool>(out);
+    }
+};
+
+namespace detail {
+
+inline std::chrono::milliseconds configured_interval() {
+    const char* value = std::getenv("MEMORY_TELEMETRY_INTERVAL_MS");
+    long ms = value ? std::atol(value) : 10;
+    return std::chrono::milliseconds(ms > 0 ? ms : 10);
+}
+
+// Created on first use and never destroyed, so markers in late static
+// destructors still find it.
+inline Sampler& process_sampler() {
+    static Sampler* instance = new Sampler(configured_interval());
+    return *instance;
+}
+
+inline void write_at_exit() {
+    Sampler& sampler = process_sampler();
+    sampler.stop();
+    const char* configured = std::getenv("MEMORY_TELEMETRY");
+    std::string path = configured && *configured ? configured : "memory_telemetry.csv";
+    std::vector<Sample> all = sampler.timeline();
+    uint64_t peak = 0;
+    for (const Sample& s : all) {
+        peak = std::max(peak, s.peak_rss);
+    }
+    bool written = sampler.write(path);
+    std::fprintf(stderr, "memory_telemetry: %zu samples (%zu dropped), peak RSS %llu KiB, %llu minor / %llu major "
+                 "faults; %s %s\n",
+                 all.size(), sampler.dropped(), static_cast<unsigned long long>(peak >> 10),
+                 static_cast<unsigned long long>(all.empty() ? 0 : all.back().minor_faults),
+                 static_cast<unsigned long long>(all.empty() ? 0 : all.back().major_faults),
+                 written ? "wrote" : "could not write", path.c_str());
+}
+
+} // namespace detail
+
+// Labels the process-wide timeline with "<label> begin" now and
+// "<label> end" when the scope exits. Does nothing unless MEMORY_TELEMETRY
+// is defined.
+class Marker {
+private:
+    char label[Sample::LABEL_BYTES];
+
+public:
+    explicit Marker(const char* name) {
+        if constexpr (enabled) {
+            size_t length = std::min(std::strlen(name), sizeof(label) - 1);
+            std::memcpy(label, name, length);
+            label[length] = '\0';
+            detail::process_sampler().mark(label, " begin");
+        }
+    }
+
+    explicit Marker(const std::string& name) : Marker(name.c_str()) {}
+
+    ~Marker() {
+        if constexpr (enabled) {
+            detail::process_sampler().mark(label, " end");
+        }
+    }
+
+    Marker(const Marker&) = delete;
+    Marker& operator=(const Marker&) = delete;
+};
+
+} // namespace memory_telemetry
+
+#ifdef MEMORY_TELEMETRY
+
+inline const bool memory_telemetry_started = (memory_telemetry::detail::process_sampler().start(),
+                                              std::atexit(memory_telemetry::detail::write_at_exit), true);
+
+#endif
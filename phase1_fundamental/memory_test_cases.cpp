@@ -1,15 +1,29 @@
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <fstream>
 #include <cassert>
 #include <vector>
+#include <string>
+
+#include "alloc_tracker.h"
+#include "heap_profiler.h"
+#include "memory_telemetry.h"
+#include "mapped_file.h"
+#include "output_sink.h"
+#include "test_runner.h"
+
+// Progress output is buffered and written at the flush points below (and
+// at exit), not once per line. Created before any tracked test runs, so
+// its buffer never counts as a test's allocation.
+static OutputSink& out = OutputSink::standard();
 
 class MemoryLeakTests {
 public:
     // Test Case 1: Verify basic leak is fixed
     static void testBasicLeakFix() {
-        std::cout << "Testing: Basic leak fix...\n";
+        out << "Testing: Basic leak fix...\n";
         
         // This should NOT leak memory
         int* data = new int[1000];
@@ -25,12 +39,12 @@ public:
         // Proper cleanup
         delete[] data;
         
-        std::cout << "✓ Basic leak test passed\n";
+        out << "✓ Basic leak test passed\n";
     }
     
     // Test Case 2: Verify exception safety
     static void testExceptionSafety() {
-        std::cout << "Testing: Exception safety...\n";
+        out << "Testing: Exception safety...\n";
         
         int attempts = 0;
         int successes = 0;
@@ -70,17 +84,17 @@ public:
             }
             catch (...) {
                 // Outer catch for any other issues
-                std::cout << "Unexpected exception in trial " << trial << "\n";
+                out << "Unexpected exception in trial " << trial << "\n";
             }
         }
         
-        std::cout << "✓ Exception safety test: " << attempts << " attempts, " 
-                  << successes << " successes, " << exceptions << " exceptions handled\n";
+        out << "✓ Exception safety test: " << attempts << " attempts, " 
+            << successes << " successes, " << exceptions << " exceptions handled\n";
     }
     
     // Test Case 3: Verify resource cleanup
     static void testResourceCleanup() {
-        std::cout << "Testing: Resource cleanup...\n";
+        out << "Testing: Resource cleanup...\n";
         
         const char* filename = "test_resource.txt";
         
@@ -93,23 +107,38 @@ public:
             }
         }
         
-        // Verify file was written and can be read
+        // Verify file was written and can be read: the mapping is unmapped
+        // when it goes out of scope, and the line is a view, not a copy
         {
-            std::ifstream file(filename);
-            std::string content;
-            std::getline(file, content);
+            MappedFile file(filename);
+            file.advise(MappedFile::Advice::Sequential);
+            std::string_view content = *file.lines().begin();
             assert(content == "Test data");
+            (void)content;
+        }
+        
+        // Read-write mapping: change the file in place and read it back
+        {
+            MappedFile file(filename, MappedFile::Access::ReadWrite);
+            std::memcpy(file.mutable_data(), "Best", 4);
+            bool synced = file.sync();
+            assert(synced);
+            (void)synced;
+        }
+        {
+            MappedFile file(filename);
+            assert(file.view() == "Best data");
         }
         
         // Clean up test file
         std::remove(filename);
         
-        std::cout << "✓ Resource cleanup test passed\n";
+        out << "✓ Resource cleanup test passed\n";
     }
     
     // Test Case 4: Memory usage pattern test
     static void testMemoryUsagePattern() {
-        std::cout << "Testing: Memory usage patterns...\n";
+        out << "Testing: Memory usage patterns...\n";
         
         // Test that we can allocate and deallocate large amounts without issues
         const int iterations = 1000;
@@ -126,13 +155,13 @@ public:
             delete[] data;
         }
         
-        std::cout << "✓ Memory pattern test: " << iterations 
-                  << " allocations/deallocations completed\n";
+        out << "✓ Memory pattern test: " << iterations 
+            << " allocations/deallocations completed\n";
     }
     
     // Test Case 5: Stress test for edge cases
     static void testEdgeCases() {
-        std::cout << "Testing: Edge cases...\n";
+        out << "Testing: Edge cases...\n";
         
         // Test 1: Zero-size allocation (implementation defined)
         int* ptr1 = new int[0];
@@ -149,35 +178,67 @@ public:
             delete ptr;
         }
         
-        std::cout << "✓ Edge cases test passed\n";
+        out << "✓ Edge cases test passed\n";
     }
 };
 
-// Helper function to run all tests
-void runAllMemoryTests() {
-    std::cout << "\n" << std::string(50, '=') << "\n";
-    std::cout << "RUNNING MEMORY MANAGEMENT TESTS\n";
-    std::cout << std::string(50, '=') << "\n";
+// Runs one test case. Built with -DMEMORY_TRACKER, it also fails the case
+// if it returns with allocations still live on this thread; built with
+// -DMEMORY_TELEMETRY, it marks the case on the memory timeline.
+template<typename Test>
+void runTrackedTest(const char* name, Test test) {
+    memory_telemetry::Marker marker(name);
+    alloc_tracker::Scope scope;
+    test();
+    if (scope.net_blocks() != 0) {
+        throw std::runtime_error(std::string(name) + " leaked " +
+                                 std::to_string(scope.net_blocks()) + " blocks (" +
+                                 std::to_string(scope.net_bytes()) + " bytes)");
+    }
+}
+
+template<typename Test>
+void addTrackedTest(test_runner::Runner& runner, const char* name, Test test) {
+    runner.add(name, [name, test] { runTrackedTest(name, test); });
+}
+
+// Runs all tests through test_runner: each case in its own process by
+// default, in parallel, so a failure or crash in one doesn't stop the
+// others (--no-fork, --jobs=N, --json=FILE; see test_runner.h). Returns
+// the number of failed cases.
+size_t runAllMemoryTests(int argc, char** argv) {
+    out << "\n" << std::string(50, '=') << "\n";
+    out << "RUNNING MEMORY MANAGEMENT TESTS\n";
+    out << std::string(50, '=') << "\n";
     
-    try {
-        MemoryLeakTests::testBasicLeakFix();
-        MemoryLeakTests::testExceptionSafety();
-        MemoryLeakTests::testResourceCleanup();
-        MemoryLeakTests::testMemoryUsagePattern();
-        MemoryLeakTests::testEdgeCases();
-        
-        std::cout << "\n✓ ALL TESTS PASSED!\n";
-        std::cout << "Memory management appears to be working correctly.\n";
+    test_runner::Runner runner("memory_test_cases", argc, argv);
+    addTrackedTest(runner, "testBasicLeakFix", MemoryLeakTests::testBasicLeakFix);
+    addTrackedTest(runner, "testExceptionSafety", MemoryLeakTests::testExceptionSafety);
+    addTrackedTest(runner, "testResourceCleanup", MemoryLeakTests::testResourceCleanup);
+    addTrackedTest(runner, "testMemoryUsagePattern", MemoryLeakTests::testMemoryUsagePattern);
+    addTrackedTest(runner, "testEdgeCases", MemoryLeakTests::testEdgeCases);
+    size_t failures = runner.run();
+    
+    if (failures != 0) {
+        out << "\n✗ " << failures << " TEST(S) FAILED\n";
+        return failures;
     }
-    catch (const std::exception& e) {
-        std::cout << "\n✗ TEST FAILED: " << e.what() << "\n";
+    out << "\n✓ ALL TESTS PASSED!\n";
+    out << "Memory management appears to be working correctly.\n";
+    if (alloc_tracker::enabled) {
+        out.flush();
+        alloc_tracker::report(std::cout, 5);
+        std::cout.flush();
     }
-    catch (...) {
-        std::cout << "\n✗ UNKNOWN TEST FAILURE\n";
+    if (heap_profiler::enabled) {
+        heap_profiler::Stats profile = heap_profiler::stats();
+        out << "heap_profiler: " << profile.samples << " samples at 1 per "
+            << heap_profiler::sample_rate() << " bytes, " << profile.live_samples
+            << " still live\n";
     }
+    return 0;
 }
 
-int main() {
-    runAllMemoryTests();
-    return 0;
+int main(int argc, char** argv) {
+    return runAllMemoryTests(argc, argv) == 0 ? 0 : 1;
 }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "simple_pool.h"
+
+// Pool of constructed objects over raw FixedPool storage.
+//
+// Unlike a vector<T> of default-constructed slots, nothing is constructed up
+// front and T needs no default constructor: create() placement-news a T
+// from its arguments, destroy() runs the destructor and recycles the slot.
+// The first chunk is only requested from upstream on the first create(), so
+// an unused pool costs no memory.
+//
+// create() returns a Ptr, a unique_ptr whose deleter hands the object back
+// to this pool; the pool must outlive every Ptr it produced.
+template<typename T>
+class ObjectPool {
+private:
+    static constexpr size_t FIRST_CHUNK = 64;
+    FixedPool pool;
+
+public:
+    class Deleter {
+    private:
+        ObjectPool* owner = nullptr;
+
+    public:
+        Deleter() = default;
+        explicit Deleter(ObjectPool* pool) : owner(pool) {}
+
+        void operator()(T* ptr) const { owner->destroy(ptr); }
+    };
+
+    using Ptr = std::unique_ptr<T, Deleter>;
+
+    explicit ObjectPool(size_t first_chunk = FIRST_CHUNK,
+                        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : pool(sizeof(T), alignof(T), first_chunk, upstream) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Constructs a T in a free slot. If the constructor throws, the slot
+    // goes back to the pool and the exception propagates.
+    template<typename... Args>
+    T* construct(Args&&... args) {
+        void* slot = pool.allocate();
+        try {
+            return new (slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.deallocate(slot);
+            throw;
+        }
+    }
+
+    template<typename... Args>
+    Ptr create(Args&&... args) {
+        return Ptr(construct(std::forward<Args>(args)...), Deleter(this));
+    }
+
+    void destroy(T* ptr) {
+        if (!ptr) {
+            return;
+        }
+        ptr->~T();
+        pool.deallocate(ptr);
+    }
+
+    // Grow ahead of time so the next `count` creates never hit upstream.
+    void reserve(size_t count) { pool.reserve(count); }
+
+    size_t live_count() const { return pool.live_count(); }
+    size_t capacity() const { return pool.capacity(); }
+    size_t footprint_bytes() const { return pool.footprint_bytes(); }
+};
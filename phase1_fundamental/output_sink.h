@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+// Buffered text output straight to a file descriptor.
+//
+// std::cout << x << std::endl costs a flush, and therefore a write(2), per
+// line, and every << goes through the locale and sentry machinery. An
+// OutputSink appends into one large buffer and only calls write(2) when
+// it fills or on an explicit flush(). Integers are formatted with
+// std::to_chars and pointers with a hex loop, neither locale-aware.
+//
+// In Mode::Background a writer thread owns the syscalls: the caller fills
+// one buffer while the thread writes the other, and only waits if it
+// fills its buffer before the previous one is out.
+//
+// Nothing is written until a flush point: the buffer filling, flush(), or
+// destruction. standard() is the process-wide stdout sink and is flushed
+// when statics are destroyed (return from main or exit(), not abort() or
+// _exit()). Sharing stdout with std::cout/printf needs a flush of the
+// other side at each switch, or output comes out of order.
+//
+// Not thread-safe for concurrent writers; give each thread its own sink.
+class OutputSink {
+public:
+    enum class Mode { Inline, Background };
+
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+private:
+    int fd;
+    Mode mode;
+    size_t capacity;
+    std::unique_ptr<char[]> front;      // filled by the caller
+    size_t used = 0;
+    std::atomic<size_t> write_calls{0};
+    std::atomic<bool> failed{false};
+
+    // Background mode: the writer thread owns `back` while back_busy.
+    std::unique_ptr<char[]> back;
+    size_t back_used = 0;
+    bool back_busy = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread writer;
+
+    void write_all(const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            write_calls.fetch_add(1, std::memory_order_relaxed);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    void wait_for_writer(std::unique_lock<std::mutex>& lock) {
+        changed.wait(lock, [this] { return !back_busy; });
+    }
+
+    // Empties the front buffer: writes it, or swaps it to the writer thread.
+    void drain() {
+        if (used == 0) {
+            return;
+        }
+        if (mode == Mode::Inline) {
+            write_all(front.get(), used);
+            used = 0;
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        wait_for_writer(lock);
+        std::swap(front, back);
+        back_used = used;
+        used = 0;
+        back_busy = true;
+        changed.notify_all();
+    }
+
+    void writer_loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this] { return back_busy || stopping; });
+            if (!back_busy) {
+                return;
+            }
+            lock.unlock();
+            write_all(back.get(), back_used);
+            lock.lock();
+            back_busy = false;
+            changed.notify_all();
+        }
+    }
+
+    template<typename T>
+    static constexpr bool is_number = std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>;
+
+public:
+    explicit OutputSink(int descriptor = STDOUT_FILENO, Mode writer_mode = Mode::Inline,
+                        size_t buffer_bytes = DEFAULT_CAPACITY)
+        : fd(descriptor), mode(writer_mode), capacity(buffer_bytes < 64 ? 64 : buffer_bytes),
+          front(new char[capacity]) {
+        if (mode == Mode::Background) {
+            back.reset(new char[capacity]);
+            writer = std::thread([this] { writer_loop(); });
+        }
+    }
+
+    ~OutputSink() {
+        flush();
+        if (writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            writer.join();
+        }
+    }
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    // The stdout sink, flushed at normal process exit.
+    static OutputSink& standard() {
+        static OutputSink sink(STDOUT_FILENO);
+        return sink;
+    }
+
+    // Returns once everything written so far has reached the descriptor.
+    void flush() {
+        drain();
+        if (mode == Mode::Background) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wait_for_writer(lock);
+        }
+    }
+
+    OutputSink& write(const char* data, size_t size) {
+        if (size > capacity - used) {
+            flush();
+            if (size >= capacity) {
+                write_all(data, size);      // too big to be worth copying
+                return *this;
+            }
+        }
+        std::memcpy(front.get() + used, data, size);
+        used += size;
+        return *this;
+    }
+
+    // At least `size` bytes of buffer to format into; then commit() them.
+    char* reserve(size_t size) {
+        if (size > capacity - used) {
+            drain();
+        }
+        return front.get() + used;
+    }
+
+    void commit(size_t size) { used += size; }
+
+    OutputSink& operator<<(std::string_view text) { return write(text.data(), text.size()); }
+    OutputSink& operator<<(const char* text) { return *this << std::string_view(text); }
+
+    OutputSink& operator<<(char c) {
+        *reserve(1) = c;
+        commit(1);
+        return *this;
+    }
+
+    template<typename T, typename = std::enable_if_t<is_number<T>>>
+    OutputSink& operator<<(T value) {
+        char* out = reserve(24);
+        commit(std::to_chars(out, out + 24, value).ptr - out);
+        return *this;
+    }
+
+    // Same text as iostream: 0x-prefixed lowercase hex, "0" for null.
+    OutputSink& operator<<(const void* pointer) {
+        uintptr_t bits = reinterpret_cast<uintptr_t>(pointer);
+        if (bits == 0) {
+            return *this << '0';
+        }
+        char digits[2 * sizeof(uintptr_t)];
+        char* p = digits + sizeof(digits);
+        for (; bits; bits >>= 4) {
+            *--p = "0123456789abcdef"[bits & 0xf];
+        }
+        char* out = reserve(2 + sizeof(digits));
+        out[0] = '0';
+        out[1] = 'x';
+        size_t length = digits + sizeof(digits) - p;
+        std::memcpy(out + 2, p, length);
+        commit(2 + length);
+        return *this;
+    }
+
+    // %g with 6 significant digits, like the default ostream format.
+    OutputSink& operator<<(double value) {
+        char* out = reserve(32);
+        commit(std::to_chars(out, out + 32, value, std::chars_format::general, 6).ptr - out);
+        return *this;
+    }
+
+    // write(2) calls made so far, and whether any of them failed.
+    size_t syscalls() const { return write_calls.load(std::memory_order_relaxed); }
+    bool ok() const { return !failed.load(std::memory_order_relaxed); }
+    size_t buffered() const { return used; }
+};
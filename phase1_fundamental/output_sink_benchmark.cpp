@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_harness.h"
+#include "output_sink.h"
+
+// Cost of writing demonstrateStackFrames-style lines
+//   Frame 5 variable at: 0x7ffd5a3c1a2c (value: 50)
+// to stdout through std::cout (with and without std::endl and
+// sync_with_stdio) and through OutputSink.
+//
+// sync_with_stdio(false) only takes effect before the first output, so
+// every variant runs in a forked child with stdout on /dev/null. The child
+// reports its write(2) count from /proc/self/io (syscw) through a pipe.
+class SinkBenchmark {
+public:
+    enum class Variant { CoutEndl, CoutNewline, CoutUnsyncedEndl, CoutUnsynced, SinkInline, SinkBackground };
+
+    struct Row {
+        std::string name;
+        double ns_per_line;
+        double syscalls_per_million;
+    };
+
+    static std::vector<Row> rows;
+
+    static long syscallWrites() {
+        FILE* io = std::fopen("/proc/self/io", "r");
+        if (!io) {
+            return -1;
+        }
+        char key[32];
+        long value = 0;
+        long writes = -1;
+        while (std::fscanf(io, "%31s %ld", key, &value) == 2) {
+            if (std::string(key) == "syscw:") {
+                writes = value;
+            }
+        }
+        std::fclose(io);
+        return writes;
+    }
+
+    static void writeLines(Variant variant, long lines) {
+        int frame_var = 0;
+        const void* address = &frame_var;
+        switch (variant) {
+        case Variant::CoutEndl:
+        case Variant::CoutUnsyncedEndl:
+            for (long i = 0; i < lines; ++i) {
+                std::cout << "Frame " << i << " variable at: " << address << " (value: " << i * 10 << ")"
+                          << std::endl;
+            }
+            break;
+        case Variant::CoutNewline:
+        case Variant::CoutUnsynced:
+            for (long i = 0; i < lines; ++i) {
+                std::cout << "Frame " << i << " variable at: " << address << " (value: " << i * 10 << ")\n";
+            }
+            std::cout.flush();
+            break;
+        case Variant::SinkInline:
+        case Variant::SinkBackground: {
+            OutputSink out(STDOUT_FILENO, variant == Variant::SinkInline ? OutputSink::Mode::Inline
+                                                                          : OutputSink::Mode::Background);
+            for (long i = 0; i < lines; ++i) {
+                out << "Frame " << i << " variable at: " << address << " (value: " << i * 10 << ")\n";
+            }
+            out.flush();
+            break;
+        }
+        }
+    }
+
+    // One call: fork, write `lines` lines in the child, collect its syscw.
+    static long runChild(Variant variant, long lines) {
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0) {
+            std::perror("pipe");
+            std::exit(1);
+        }
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            int null_fd = open("/dev/null", O_WRONLY);
+            dup2(null_fd, STDOUT_FILENO);
+            close(null_fd);
+            if (variant == Variant::CoutUnsyncedEndl || variant == Variant::CoutUnsynced) {
+                std::ios::sync_with_stdio(false);
+            }
+            long before = syscallWrites();
+            writeLines(variant, lines);
+            long writes = syscallWrites() - before;
+            ssize_t sent = write(pipe_fds[1], &writes, sizeof(writes));
+            _exit(sent == sizeof(writes) ? 0 : 1);
+        }
+        close(pipe_fds[1]);
+        long writes = -1;
+        if (read(pipe_fds[0], &writes, sizeof(writes)) != sizeof(writes)) {
+            writes = -1;
+        }
+        close(pipe_fds[0]);
+        waitpid(pid, nullptr, 0);
+        return writes;
+    }
+
+    static void measure(bench::Suite& suite, const std::string& name, Variant variant, long lines) {
+        long writes = 0;
+        auto result = suite.run_once(name, [&] { writes = runChild(variant, lines); }, lines);
+        rows.push_back(Row{name, result.median, writes * 1e6 / lines});
+    }
+};
+
+std::vector<SinkBenchmark::Row> SinkBenchmark::rows;
+
+int main(int argc, char** argv) {
+    long lines = 1000000;
+    if (argc > 1 && argv[1][0] != '-') {
+        lines = std::atol(argv[1]);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 5;
+    bench::Suite suite("output_sink_benchmark", argc, argv, options);
+
+    using V = SinkBenchmark::Variant;
+    SinkBenchmark::measure(suite, "cout << std::endl", V::CoutEndl, lines);
+    SinkBenchmark::measure(suite, "cout << '\\n'", V::CoutNewline, lines);
+    SinkBenchmark::measure(suite, "cout << std::endl, unsynced", V::CoutUnsyncedEndl, lines);
+    SinkBenchmark::measure(suite, "cout << '\\n', unsynced", V::CoutUnsynced, lines);
+    SinkBenchmark::measure(suite, "OutputSink", V::SinkInline, lines);
+    SinkBenchmark::measure(suite, "OutputSink background", V::SinkBackground, lines);
+
+    std::printf("\n%ld lines to /dev/null\n%-30s %12s %18s\n", lines, "writer", "ns/line", "write(2) per 1M");
+    for (const auto& row : SinkBenchmark::rows) {
+        std::printf("%-30s %12.1f %18.0f\n", row.name.c_str(), row.ns_per_line, row.syscalls_per_million);
+    }
+    return 0;
+}
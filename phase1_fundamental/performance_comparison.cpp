@@ -1,40 +1,152 @@
 #include <iostream>
-#include <chrono>
+#include <string>
 #include <vector>
 
+#include "arena.h"
+#include "bench_harness.h"
+#include "size_class_allocator.h"
+#include "small_vector.h"
+
 class PerformanceTest {
 public:
-    static void compareStackVsHeap(const int iterations = 1000000) {        
+    // Each strategy runs `iterations` allocate/use/free cycles per call; the
+    // harness repeats the call and reports nanoseconds per cycle.
+    static void compareStackVsHeap(bench::Suite& suite, const int iterations = 1000000) {
+        std::cout << "\n" << iterations << " iterations per call:\n";
+        const std::string suffix = " x" + std::to_string(iterations);
+
         // Test 1: Stack allocation
-        auto start = std::chrono::high_resolution_clock::now();
-        for (int i = 0; i < iterations; ++i) {
-            int stack_array[100];
-            stack_array[0] = i;  // Use the array
-        }
-        auto end = std::chrono::high_resolution_clock::now();
-        auto stack_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        
+        auto stack = suite.run("stack int[100]" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                int stack_array[100];
+                stack_array[0] = i;  // Use the array
+                int* escaped = stack_array;
+                bench::DoNotOptimize(escaped);
+            }
+        }, iterations);
+
         // Test 2: Heap allocation
-				
-        start = std::chrono::high_resolution_clock::now();
-        for (int i = 0; i < iterations; ++i) {
-            int* heap_array = new int[100];
-            heap_array[0] = i;  // Use the array
-            delete[] heap_array;
-        }
-        end = std::chrono::high_resolution_clock::now();
-        auto heap_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        
-        std::cout << "Stack allocation time: " << stack_time.count() << " microseconds\n";
-        std::cout << "Heap allocation time:  " << heap_time.count() << " microseconds\n";
-        std::cout << "Heap is " << (double)heap_time.count() / stack_time.count() 
-                  << "x slower than stack\n";
+        auto heap = suite.run("new int[100]" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                int* heap_array = new int[100];
+                heap_array[0] = i;  // Use the array
+                bench::DoNotOptimize(heap_array);
+                delete[] heap_array;
+            }
+        }, iterations);
+
+        // Test 3: Size-class allocator
+        SizeClassAllocator<> allocator;
+        auto pooled = suite.run("size-class int[100]" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                int* pooled_array = static_cast<int*>(allocator.allocate(100 * sizeof(int)));
+                pooled_array[0] = i;  // Use the array
+                bench::DoNotOptimize(pooled_array);
+                allocator.deallocate(pooled_array);
+            }
+        }, iterations);
+
+        // Test 4: Arena, rewound at the end of every iteration
+        Arena arena;
+        auto arena_result = suite.run("arena int[100]" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                Arena::Scope scope(arena);
+                int* arena_array = arena.allocate_array<int>(100);
+                arena_array[0] = i;  // Use the array
+                bench::DoNotOptimize(arena_array);
+            }
+        }, iterations);
+
+        std::cout << "Heap is " << heap.median / stack.median << "x slower than stack\n";
+        std::cout << "Size-class allocator is " << heap.median / pooled.median
+                  << "x faster than heap\n";
+        std::cout << "Arena is " << heap.median / arena_result.median << "x faster than heap\n";
+    }
+
+    // A growable array of `size` ints, built and dropped each iteration:
+    // below, at and above small_vector's inline capacity of INLINE.
+    static constexpr size_t INLINE = 32;
+
+    static void compareSmallVector(bench::Suite& suite, const int size, const int iterations = 100000) {
+        std::cout << "\n" << size << " ints (inline capacity " << INLINE << "), "
+                  << iterations << " iterations per call:\n";
+        const std::string suffix = " n=" + std::to_string(size);
+
+        // Test 1: Stack array sized for the largest case
+        auto stack = suite.run("stack int[128]" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                int stack_array[128];
+                for (int j = 0; j < size; ++j) {
+                    stack_array[j] = i + j;
+                }
+                int* escaped = stack_array;
+                bench::DoNotOptimize(escaped);
+            }
+        }, iterations);
+
+        // Test 2: small_vector, spilling to the heap past INLINE
+        auto small = suite.run("small_vector<int, 32>" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                small_vector<int, INLINE> values;
+                for (int j = 0; j < size; ++j) {
+                    values.push_back(i + j);
+                }
+                bench::DoNotOptimize(values.data());
+            }
+        }, iterations);
+
+        // Test 3: small_vector spilling to an arena, rewound every iteration
+        Arena arena;
+        ArenaResource arena_resource(arena);
+        auto small_arena = suite.run("small_vector<int, 32> arena" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                Arena::Scope scope(arena);
+                small_vector<int, INLINE> values(&arena_resource);
+                for (int j = 0; j < size; ++j) {
+                    values.push_back(i + j);
+                }
+                bench::DoNotOptimize(values.data());
+            }
+        }, iterations);
+
+        // Test 4: std::vector
+        auto vector = suite.run("std::vector<int>" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                std::vector<int> values;
+                for (int j = 0; j < size; ++j) {
+                    values.push_back(i + j);
+                }
+                bench::DoNotOptimize(values.data());
+            }
+        }, iterations);
+
+        // Test 5: Heap array of exactly the right size
+        auto heap = suite.run("new int[n]" + suffix, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                int* heap_array = new int[size];
+                for (int j = 0; j < size; ++j) {
+                    heap_array[j] = i + j;
+                }
+                bench::DoNotOptimize(heap_array);
+                delete[] heap_array;
+            }
+        }, iterations);
+
+        std::cout << "small_vector is " << vector.median / small.median << "x faster than std::vector, "
+                  << small.median / stack.median << "x slower than stack\n";
+        std::cout << "small_vector with arena spill is " << vector.median / small_arena.median
+                  << "x faster than std::vector\n";
+        std::cout << "new int[n] is " << vector.median / heap.median << "x faster than std::vector\n";
     }
 };
 
-int main() {
-		PerformanceTest::compareStackVsHeap(10);
-		PerformanceTest::compareStackVsHeap(1000);
-		PerformanceTest::compareStackVsHeap(1000000);
+int main(int argc, char** argv) {
+		bench::Suite suite("performance_comparison", argc, argv);
+		PerformanceTest::compareStackVsHeap(suite, 10);
+		PerformanceTest::compareStackVsHeap(suite, 1000);
+		PerformanceTest::compareStackVsHeap(suite, 1000000);
+		PerformanceTest::compareSmallVector(suite, 8);
+		PerformanceTest::compareSmallVector(suite, 32);
+		PerformanceTest::compareSmallVector(suite, 128);
 		return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#include "simple_pool.h"
+
+// std::pmr::memory_resource backed by one FixedPool per size class.
+//
+// Requests up to MAX_POOLED bytes are rounded up to a multiple of
+// GRANULARITY and served from that class's pool; larger or over-aligned
+// requests go to the upstream resource. Like
+// std::pmr::unsynchronized_pool_resource it is not thread-safe, and memory
+// goes back upstream only when the resource is destroyed.
+class PoolResource final : public std::pmr::memory_resource {
+private:
+    static constexpr size_t GRANULARITY = 16;
+    static constexpr size_t MAX_POOLED = 512;
+    static constexpr size_t FIRST_CHUNK_BYTES = 16 * 1024;
+
+    std::vector<FixedPool> pools;
+    std::pmr::memory_resource* upstream;
+
+    static size_t class_index(size_t bytes) {
+        return bytes == 0 ? 0 : (bytes - 1) / GRANULARITY;
+    }
+
+    static bool pooled(size_t bytes, size_t alignment) {
+        return bytes <= MAX_POOLED && alignment <= GRANULARITY;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (!pooled(bytes, alignment)) {
+            return upstream->allocate(bytes, alignment);
+        }
+        return pools[class_index(bytes)].allocate();
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        if (!pooled(bytes, alignment)) {
+            upstream->deallocate(ptr, bytes, alignment);
+            return;
+        }
+        pools[class_index(bytes)].deallocate(ptr);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit PoolResource(std::pmr::memory_resource* upstream_resource = std::pmr::new_delete_resource())
+        : upstream(upstream_resource) {
+        pools.reserve(MAX_POOLED / GRANULARITY);
+        for (size_t size = GRANULARITY; size <= MAX_POOLED; size += GRANULARITY) {
+            pools.emplace_back(size, GRANULARITY, FIRST_CHUNK_BYTES / size);
+        }
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    // Bytes currently held from upstream by the pooled size classes.
+    size_t footprint_bytes() const {
+        size_t total = 0;
+        for (const auto& pool : pools) {
+            total += pool.footprint_bytes();
+        }
+        return total;
+    }
+};
+
+// Standard Allocator that draws from a PoolResource.
+//
+// Rebinding keeps the same resource, so node-based containers and
+// std::allocate_shared get their nodes and control blocks from the pool.
+// Two allocators compare equal when they share a resource.
+template<typename T>
+class PoolAllocator {
+private:
+    PoolResource* resource;
+
+    template<typename U> friend class PoolAllocator;
+
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U>;
+    };
+
+    explicit PoolAllocator(PoolResource& pool_resource) noexcept : resource(&pool_resource) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : resource(other.resource) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept {
+        return resource == other.resource;
+    }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const noexcept {
+        return resource != other.resource;
+    }
+};
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "simple_pool.h"
+
+// The original SimplePool, kept here as the baseline: a fixed vector of
+// default-constructed objects plus a second vector of free pointers.
+template<typename T>
+class VectorPool {
+private:
+    static constexpr size_t POOL_SIZE = 1024;
+    std::vector<T> pool;
+    std::vector<T*> available;
+
+public:
+    VectorPool() : pool(POOL_SIZE) {
+        for (auto& item : pool) {
+            available.push_back(&item);
+        }
+    }
+
+    T* allocate() {
+        if (available.empty()) {
+            throw std::bad_alloc();
+        }
+        T* ptr = available.back();
+        available.pop_back();
+        return ptr;
+    }
+
+    void deallocate(T* ptr) {
+        available.push_back(ptr);
+    }
+
+    size_t footprint_bytes() const {
+        return pool.capacity() * sizeof(T) + available.capacity() * sizeof(T*);
+    }
+};
+
+struct Particle {
+    double x, y, z;
+    double mass;
+};
+
+class PoolBenchmark {
+public:
+    // One call allocates `batch` objects, touches them and frees them in
+    // reverse order. The batch stays below 1024 so the legacy pool can run
+    // the same workload.
+    template<typename T, typename Alloc, typename Free>
+    static double allocsPerSecond(bench::Suite& suite, const std::string& name,
+                                  Alloc alloc, Free release, int batch) {
+        std::vector<T*> held(batch);
+        auto result = suite.run(name, [&] {
+            for (int i = 0; i < batch; ++i) {
+                T* p = alloc();
+                *reinterpret_cast<char*>(p) = static_cast<char>(i);
+                held[i] = p;
+            }
+            bench::DoNotOptimize(held.data());
+            for (int i = batch - 1; i >= 0; --i) {
+                release(held[i]);
+            }
+        }, batch);
+        return result.ops_per_second();
+    }
+
+    // Heap overhead of `count` live objects from operator new, from mallinfo2.
+    template<typename T>
+    static double newOverheadPerObject(int count) {
+        std::vector<T*> held;
+        held.reserve(count);
+        size_t before = mallinfo2().uordblks;
+        for (int i = 0; i < count; ++i) {
+            held.push_back(new T());
+        }
+        size_t after = mallinfo2().uordblks;
+        for (T* p : held) {
+            delete p;
+        }
+        return static_cast<double>(after - before) / count - sizeof(T);
+    }
+
+    template<typename T>
+    static void compare(bench::Suite& suite, const std::string& name) {
+        const int batch = 1000;
+
+        VectorPool<T> legacy;
+        SimplePool<T> pool;
+
+        std::cout << "\n=== " << name << " (sizeof = " << sizeof(T) << ") ===\n";
+        double legacy_rate = allocsPerSecond<T>(suite, name + " VectorPool",
+            [&] { return legacy.allocate(); },
+            [&](T* p) { legacy.deallocate(p); }, batch);
+        double pool_rate = allocsPerSecond<T>(suite, name + " SimplePool",
+            [&] { return pool.allocate(); },
+            [&](T* p) { pool.deallocate(p); }, batch);
+        double new_rate = allocsPerSecond<T>(suite, name + " operator new",
+            [] { return static_cast<T*>(::operator new(sizeof(T))); },
+            [](T* p) { ::operator delete(p); }, batch);
+
+        // Fill the pool once more so the overhead figure covers a full chunk.
+        while (pool.available_count() > 0) {
+            pool.allocate();
+        }
+        double legacy_overhead = static_cast<double>(legacy.footprint_bytes()) / 1024 - sizeof(T);
+        double pool_overhead = static_cast<double>(pool.footprint_bytes()) / pool.capacity() - sizeof(T);
+        double new_overhead = newOverheadPerObject<T>(100000);
+
+        std::cout << "VectorPool (legacy): " << legacy_rate / 1e6 << " M allocs/s, "
+                  << legacy_overhead << " bytes overhead/object\n";
+        std::cout << "SimplePool:          " << pool_rate / 1e6 << " M allocs/s, "
+                  << pool_overhead << " bytes overhead/object\n";
+        std::cout << "operator new:        " << new_rate / 1e6 << " M allocs/s, "
+                  << new_overhead << " bytes overhead/object\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    bench::Suite suite("pool_benchmark", argc, argv);
+    PoolBenchmark::compare<int>(suite, "int");
+    PoolBenchmark::compare<Particle>(suite, "Particle");
+    return 0;
+}
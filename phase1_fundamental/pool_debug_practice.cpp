@@ -0,0 +1,92 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "simple_pool.h"
+
+// Pool misuse that a POOL_DEBUG build must catch. Each case is one bug and
+// is picked by name so every run dies on exactly one report:
+//
+//   g++ -std=c++17 -g -O1 -fsanitize=address -DPOOL_DEBUG pool_debug_practice.cpp -o pool_debug_asan
+//   ./pool_debug_asan double-free
+//
+// test_pool_debug.sh runs all of them and expects each to fail.
+
+struct Record {
+    int id;
+    int values[4];      // 20 bytes: 4 bytes of block padding after it
+};
+
+int main(int argc, char** argv) {
+    std::string test = argc > 1 ? argv[1] : "ok";
+    SimplePool<Record> pool;
+
+    if (test == "ok") {
+        // Correct usage must stay silent.
+        Record* records[200];
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 200; ++i) {
+                records[i] = pool.allocate();
+                records[i]->id = i;
+            }
+            for (int i = 0; i < 200; ++i) {
+                pool.deallocate(records[i]);
+            }
+        }
+        std::cout << "ok: " << pool.capacity() << " slots, none live\n";
+        return 0;
+    }
+
+    // 1. Use after free (read): ASan reports use-after-poison
+    if (test == "use-after-free") {
+        Record* r = pool.allocate();
+        r->id = 1;
+        pool.deallocate(r);
+        volatile int id = r->id;
+        std::cout << "read " << id << " from a freed slot\n";
+    }
+
+    // 2. Write after free: the quarantine finds the damaged fill pattern
+    //    when the slot is recycled, even without ASan
+    if (test == "write-after-free") {
+        Record* r = pool.allocate();
+        pool.deallocate(r);
+        r->values[2] = 42;
+        for (int i = 0; i < POOL_DEBUG_QUARANTINE + 1; ++i) {
+            pool.deallocate(pool.allocate());
+        }
+        std::cout << "late write went unnoticed\n";
+    }
+
+    // 3. Double free
+    if (test == "double-free") {
+        Record* r = pool.allocate();
+        pool.deallocate(r);
+        pool.deallocate(r);
+        std::cout << "double free went unnoticed\n";
+    }
+
+    // 4. Foreign pointer: memory the pool never handed out
+    if (test == "foreign-pointer") {
+        Record on_stack{};
+        pool.allocate();
+        pool.deallocate(&on_stack);
+        std::cout << "foreign pointer went unnoticed\n";
+    }
+
+    // 5. Interior pointer: right pool, wrong address
+    if (test == "interior-pointer") {
+        Record* r = pool.allocate();
+        pool.deallocate(reinterpret_cast<Record*>(reinterpret_cast<char*>(r) + 4));
+        std::cout << "interior pointer went unnoticed\n";
+    }
+
+    // 6. Overflow into the slot padding: ASan reports use-after-poison
+    if (test == "overflow") {
+        Record* r = pool.allocate();
+        std::memset(r, 0, sizeof(Record) + 1);
+        std::cout << "overflow went unnoticed\n";
+    }
+
+    return 1;
+}
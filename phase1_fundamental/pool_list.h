@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "simple_pool.h"
+
+// Intrusive doubly linked list whose nodes live in the list's own pool.
+//
+// The shared_ptr<Node> next / weak_ptr<Node> prev design (see
+// real_circular_leak.cpp) pays two refcount updates per link, a control
+// block per node and a lock() per backwards step. Here the list is the
+// only owner of its nodes: next and prev are plain pointers, so there is
+// nothing to leak through a cycle, and nodes can't outlive the list because
+// they are carved from a FixedPool the list holds.
+//
+// Because every node is in that pool, clear() and the destructor free the
+// whole list by returning the pool's chunks: O(chunks) for trivially
+// destructible T, and one destructor call per node (but no per-node free)
+// otherwise. It also means tearing down a 10M-node list does not recurse,
+// which a shared_ptr chain does.
+template<typename T>
+class PoolList {
+private:
+    struct Links {
+        Links* next;
+        Links* prev;
+    };
+
+    struct Node : Links {
+        T value;
+
+        template<typename... Args>
+        explicit Node(Args&&... args) : Links{nullptr, nullptr}, value(std::forward<Args>(args)...) {}
+    };
+
+    static constexpr size_t FIRST_CHUNK = 256;
+
+    FixedPool pool;
+    Links sentinel;             // next is the first node, prev the last
+    size_t count = 0;
+
+    static Node* node(Links* links) { return static_cast<Node*>(links); }
+
+    void reset_sentinel() {
+        sentinel.next = &sentinel;
+        sentinel.prev = &sentinel;
+    }
+
+    // Move support: the first and last nodes point at the sentinel, which
+    // lives inside the list object.
+    void adopt(PoolList& other) {
+        if (other.count == 0) {
+            reset_sentinel();
+            return;
+        }
+        sentinel = other.sentinel;
+        sentinel.next->prev = &sentinel;
+        sentinel.prev->next = &sentinel;
+        count = std::exchange(other.count, 0);
+        other.reset_sentinel();
+    }
+
+    template<typename... Args>
+    Links* link_before(Links* position, Args&&... args) {
+        void* slot = pool.allocate();
+        Node* created;
+        try {
+            created = new (slot) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.deallocate(slot);
+            throw;
+        }
+        created->next = position;
+        created->prev = position->prev;
+        position->prev->next = created;
+        position->prev = created;
+        ++count;
+        return created;
+    }
+
+public:
+    template<bool Const>
+    class Iterator {
+    private:
+        friend class PoolList;
+        Links* links = nullptr;
+
+        explicit Iterator(Links* at) : links(at) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iterator() = default;
+        // iterator -> const_iterator
+        template<bool WasConst, typename = std::enable_if_t<Const && !WasConst>>
+        Iterator(const Iterator<WasConst>& other) : links(other.links) {}
+
+        reference operator*() const { return node(links)->value; }
+        pointer operator->() const { return &node(links)->value; }
+
+        Iterator& operator++() {
+            links = links->next;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator before = *this;
+            links = links->next;
+            return before;
+        }
+        Iterator& operator--() {
+            links = links->prev;
+            return *this;
+        }
+        Iterator operator--(int) {
+            Iterator before = *this;
+            links = links->prev;
+            return before;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.links == b.links; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.links != b.links; }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    PoolList() : pool(sizeof(Node), alignof(Node), FIRST_CHUNK) { reset_sentinel(); }
+
+    ~PoolList() { clear(); }
+
+    PoolList(const PoolList&) = delete;
+    PoolList& operator=(const PoolList&) = delete;
+
+    PoolList(PoolList&& other) noexcept : pool(std::move(other.pool)) { adopt(other); }
+
+    PoolList& operator=(PoolList&&) = delete;
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        return node(link_before(&sentinel, std::forward<Args>(args)...))->value;
+    }
+
+    template<typename... Args>
+    T& emplace_front(Args&&... args) {
+        return node(link_before(sentinel.next, std::forward<Args>(args)...))->value;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    template<typename... Args>
+    iterator emplace(const_iterator position, Args&&... args) {
+        return iterator(link_before(position.links, std::forward<Args>(args)...));
+    }
+
+    iterator insert(const_iterator position, const T& value) { return emplace(position, value); }
+
+    // Unlinks and destroys one node; returns the element after it.
+    iterator erase(const_iterator position) {
+        Links* links = position.links;
+        Links* after = links->next;
+        links->prev->next = after;
+        after->prev = links->prev;
+        Node* doomed = node(links);
+        doomed->~Node();
+        pool.deallocate(doomed);
+        --count;
+        return iterator(after);
+    }
+
+    void pop_front() { erase(begin()); }
+    void pop_back() { erase(const_iterator(sentinel.prev)); }
+
+    // Destroys every element, then frees all nodes in one go.
+    void clear() {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (Links* links = sentinel.next; links != &sentinel;) {
+                Links* next = links->next;
+                node(links)->~Node();
+                links = next;
+            }
+        }
+        pool.release();
+        reset_sentinel();
+        count = 0;
+    }
+
+    T& front() { return node(sentinel.next)->value; }
+    const T& front() const { return node(sentinel.next)->value; }
+    T& back() { return node(sentinel.prev)->value; }
+    const T& back() const { return node(sentinel.prev)->value; }
+
+    iterator begin() { return iterator(sentinel.next); }
+    iterator end() { return iterator(&sentinel); }
+    const_iterator begin() const { return const_iterator(sentinel.next); }
+    const_iterator end() const { return const_iterator(const_cast<Links*>(&sentinel)); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Bytes held by the node pool, chunk headers included.
+    size_t footprint_bytes() const { return pool.footprint_bytes(); }
+    static constexpr size_t node_size() { return sizeof(Node); }
+};
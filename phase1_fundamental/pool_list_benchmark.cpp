@@ -0,0 +1,140 @@
+#include <cstdlib>
+#include <iostream>
+#include <malloc.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "pool_list.h"
+
+// The Node from real_circular_leak.cpp without the destructor message.
+struct SharedNode {
+    int value;
+    std::shared_ptr<SharedNode> next;
+    std::weak_ptr<SharedNode> prev;
+
+    explicit SharedNode(int v) : value(v) {}
+};
+
+struct SharedList {
+    std::shared_ptr<SharedNode> head;
+    std::shared_ptr<SharedNode> tail;
+
+    void push_back(int value) {
+        auto node = std::make_shared<SharedNode>(value);
+        if (tail) {
+            node->prev = tail;
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = std::move(node);
+    }
+
+    // Unlinks front to back. Just dropping `head` would destroy the chain
+    // recursively, one stack frame per node, and overflow the stack for
+    // long lists.
+    void clear() {
+        tail.reset();
+        while (head) {
+            head = std::move(head->next);
+        }
+    }
+
+    ~SharedList() { clear(); }
+};
+
+class ListBenchmark {
+public:
+    static size_t heapBytes() {
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+    }
+
+    static void compare(bench::Suite& suite, int n) {
+        const std::string suffix = " n=" + std::to_string(n);
+        std::cout << "\n=== " << n << " nodes ===\n";
+
+        // Build and tear down, timed together: one call is one whole list.
+        auto shared_build = suite.run_once("shared_ptr/weak_ptr build+destroy" + suffix, [&] {
+            SharedList list;
+            for (int i = 0; i < n; ++i) {
+                list.push_back(i);
+            }
+        }, n);
+        auto pool_build = suite.run_once("PoolList build+destroy" + suffix, [&] {
+            PoolList<int> list;
+            for (int i = 0; i < n; ++i) {
+                list.push_back(i);
+            }
+        }, n);
+
+        size_t before = heapBytes();
+        SharedList shared;
+        for (int i = 0; i < n; ++i) {
+            shared.push_back(i);
+        }
+        double shared_bytes = static_cast<double>(heapBytes() - before) / n;
+
+        before = heapBytes();
+        PoolList<int> pooled;
+        for (int i = 0; i < n; ++i) {
+            pooled.push_back(i);
+        }
+        double pool_bytes = static_cast<double>(heapBytes() - before) / n;
+
+        auto shared_forward = suite.run_once("shared_ptr forward traverse" + suffix, [&] {
+            long sum = 0;
+            for (SharedNode* node = shared.head.get(); node; node = node->next.get()) {
+                sum += node->value;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+        auto pool_forward = suite.run_once("PoolList forward traverse" + suffix, [&] {
+            long sum = 0;
+            for (int value : pooled) {
+                sum += value;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+
+        // Backwards every step goes through weak_ptr::lock().
+        auto shared_backward = suite.run_once("weak_ptr backward traverse" + suffix, [&] {
+            long sum = 0;
+            for (auto node = shared.tail; node; node = node->prev.lock()) {
+                sum += node->value;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+        auto pool_backward = suite.run_once("PoolList backward traverse" + suffix, [&] {
+            long sum = 0;
+            for (auto it = pooled.end(); it != pooled.begin();) {
+                sum += *--it;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+
+        std::cout << "Heap bytes per node: shared_ptr " << shared_bytes << ", PoolList " << pool_bytes
+                  << " (node " << PoolList<int>::node_size() << " bytes)\n";
+        std::cout << "PoolList speedup: build+destroy " << shared_build.median / pool_build.median
+                  << "x, forward " << shared_forward.median / pool_forward.median
+                  << "x, backward " << shared_backward.median / pool_backward.median << "x\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    int max_nodes = 10000000;
+    if (argc > 1 && argv[1][0] != '-') {
+        max_nodes = std::atoi(argv[1]);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 5;
+    bench::Suite suite("pool_list_benchmark", argc, argv, options);
+
+    for (int n = 1000; n <= max_nodes; n *= 10) {
+        ListBenchmark::compare(suite, n);
+    }
+    return 0;
+}
@@ -1,10 +1,16 @@
 #include <memory>
-#include <iostream>
+
+#include "batch_ops.h"
+#include "output_sink.h"
+#include "simd_kernels.h"
+
+// All output goes through one buffered sink, flushed at exit
+static OutputSink& out = OutputSink::standard();
 
 class Resource {
 public:
-    Resource() { std::cout << "Resource Acquired\n"; }
-    ~Resource() { std::cout << "Resource Released\n"; }
+    Resource() { out << "Resource Acquired\n"; }
+    ~Resource() { out << "Resource Released\n"; }
 
 		void modifyValue(int& value) {
 			value *= 2;
@@ -12,10 +18,19 @@ public:
 
 		void processData(const int* data, size_t size) {
 			for (size_t i = 0; i < size; ++i) {
-				// Read-only access
-				std::cout << data[i] << " ";
+				// Read-only access, formatted straight into the buffer
+				out << data[i] << ' ';
 			}
-			std::cout << std::endl;
+			out << '\n';
+		}
+
+		// Read-only scans over the same span (vectorized, see simd_kernels.h)
+		long long sumData(const int* data, size_t size) const {
+			return simd::sum(data, size);
+		}
+
+		simd::MinMax rangeOf(const int* data, size_t size) const {
+			return simd::min_max(data, size);
 		}
 
 		using Operation = int (*)(int, int);
@@ -23,9 +38,18 @@ public:
 		static int add(int a, int b) { return a + b; }
 		static int substract(int a, int b) { return a - b; }
 
-		static void calculateAndPrint(Operation op, int a, int b) {
+		// Op is any int(int, int) callable: an Operation still works, but a
+		// callable type (batch::Add, batch::Function<add>) inlines
+		template<typename Op>
+		static void calculateAndPrint(Op op, int a, int b) {
 			int result = op(a, b);
-			std::cout << "Result: " << result << std::endl;
+			out << "Result: " << result << '\n';
+		}
+
+		// results[i] = op(a[i], b[i]) over whole spans (see batch_ops.h)
+		template<typename Op>
+		static void calculateBatch(Op op, const int* a, const int* b, int* results, size_t size) {
+			batch::apply(a, b, results, size, op);
 		}
 };
 
@@ -34,13 +58,23 @@ int main() {
         std::unique_ptr<Resource> res(new Resource());
 				int value = 10;
 				res->modifyValue(value);
-				std::cout << "Modified Value: " << value << std::endl;
+				out << "Modified Value: " << value << '\n';
 
 				int data[] = {1, 2, 3, 4, 5};
 				res->processData(data, sizeof(data) / sizeof(data[0]));
+				simd::MinMax range = res->rangeOf(data, sizeof(data) / sizeof(data[0]));
+				out << "Sum: " << res->sumData(data, sizeof(data) / sizeof(data[0]))
+				    << ", range: " << range.min << ".." << range.max << '\n';
 
 				Resource::calculateAndPrint(Resource::add, 5, 3);
 				Resource::calculateAndPrint(Resource::substract, 5, 3);
+
+				int lhs[] = {10, 20, 30, 40};
+				int rhs[] = {1, 2, 3, 4};
+				int sums[4];
+				Resource::calculateBatch(batch::Function<Resource::add>(), lhs, rhs, sums, 4);
+				out << "Batch add: ";
+				res->processData(sums, 4);
     }
     return 0;
 }
\ No newline at end of file
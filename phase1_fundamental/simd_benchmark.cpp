@@ -0,0 +1,131 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "simd_kernels.h"
+
+// Throughput of the simd_kernels.h scans against the element-at-a-time
+// loop Resource::processData uses, from L1-resident to DRAM-resident
+// buffers. Reported as GB/s of input read.
+class ScanBenchmark {
+public:
+    struct Row {
+        std::string kernel;
+        size_t bytes;
+        double gbps[3];     // indexed by simd::Isa
+    };
+
+    static std::vector<Row> rows;
+
+    static std::string sizeLabel(size_t bytes) {
+        return bytes >= (1 << 20) ? std::to_string(bytes >> 20) + " MiB" : std::to_string(bytes >> 10) + " KiB";
+    }
+
+    // Runs `kernel(isa)` for every Isa the CPU has and records GB/s.
+    template<typename Kernel>
+    static void measure(bench::Suite& suite, const std::string& name, size_t count, Kernel kernel) {
+        const size_t bytes = count * sizeof(int);
+        Row row{name, bytes, {0, 0, 0}};
+        for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::SSE2, simd::Isa::AVX2}) {
+            if (simd::usable(isa) != isa) {
+                continue;
+            }
+            auto result = suite.run(name + " " + simd::isa_name(isa) + " " + sizeLabel(bytes),
+                                    [&] { kernel(isa); }, bytes);
+            row.gbps[static_cast<int>(isa)] = 1.0 / result.median;   // bytes per ns == GB/s
+        }
+        rows.push_back(row);
+    }
+
+    static void scans(bench::Suite& suite, size_t bytes) {
+        const size_t count = bytes / sizeof(int);
+        std::vector<int> data(count);
+        std::vector<int> out(count);
+        std::mt19937 rng(1);
+        for (int& x : data) {
+            x = static_cast<int>(rng() % 2000001) - 1000000;
+        }
+        const int* p = data.data();
+
+        measure(suite, "sum", count, [&](simd::Isa isa) {
+            long long total = simd::sum(p, count, isa);
+            bench::DoNotOptimize(total);
+        });
+        measure(suite, "min/max", count, [&](simd::Isa isa) {
+            simd::MinMax range = simd::min_max(p, count, isa);
+            bench::DoNotOptimize(range);
+        });
+        measure(suite, "count >", count, [&](simd::Isa isa) {
+            size_t hits = simd::count(p, count, simd::Compare::Greater, 0, isa);
+            bench::DoNotOptimize(hits);
+        });
+        measure(suite, "scale_add", count, [&](simd::Isa isa) {
+            simd::scale_add(p, out.data(), count, 3, 7, isa);
+            bench::ClobberMemory();
+        });
+    }
+
+    // processData's `std::cout << data[i] << " "` (into a string stream,
+    // so the terminal isn't measured) against format_ints into a buffer.
+    static void text(bench::Suite& suite, size_t count) {
+        std::vector<int> data(count);
+        std::mt19937 rng(2);
+        for (int& x : data) {
+            x = static_cast<int>(rng());
+        }
+        std::string buffer(simd::format_ints_capacity(count), '\0');
+
+        auto stream = suite.run("ostream << int " + std::to_string(count), [&] {
+            std::ostringstream out;
+            for (size_t i = 0; i < count; ++i) {
+                out << data[i] << " ";
+            }
+            bench::DoNotOptimize(out.tellp());
+        }, count);
+        auto formatted = suite.run("format_ints " + std::to_string(count), [&] {
+            size_t written = simd::format_ints(data.data(), count, &buffer[0]);
+            bench::DoNotOptimize(written);
+        }, count);
+        std::printf("\nint-to-text, %zu ints: ostream %.1f ns/int, format_ints %.1f ns/int (%.1fx)\n", count,
+                    stream.median, formatted.median, stream.median / formatted.median);
+    }
+};
+
+std::vector<ScanBenchmark::Row> ScanBenchmark::rows;
+
+int main(int argc, char** argv) {
+    size_t max_mib = 256;
+    if (argc > 1 && argv[1][0] != '-') {
+        max_mib = std::strtoul(argv[1], nullptr, 10);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 7;
+    bench::Suite suite("simd_benchmark", argc, argv, options);
+
+    std::cout << "Detected ISA: " << simd::isa_name(simd::detected_isa()) << "\n";
+
+    // L1, L2, last-level cache, DRAM on a typical server part; the largest
+    // size should exceed the L3 (see lscpu) to be DRAM-bound.
+    for (size_t bytes : {size_t(16) << 10, size_t(1) << 20, size_t(32) << 20, max_mib << 20}) {
+        if (bytes > (max_mib << 20)) {
+            continue;
+        }
+        ScanBenchmark::scans(suite, bytes);
+    }
+    ScanBenchmark::text(suite, 100000);
+
+    std::printf("\n%-10s %9s %9s %9s %9s %8s\n", "kernel", "size", "scalar", "sse2", "avx2", "speedup");
+    for (const auto& row : ScanBenchmark::rows) {
+        double best = std::max(row.gbps[1], row.gbps[2]);
+        std::printf("%-10s %9s %8.1fG %8.1fG %8.1fG %7.1fx\n", row.kernel.c_str(),
+                    ScanBenchmark::sizeLabel(row.bytes).c_str(), row.gbps[0], row.gbps[1], row.gbps[2],
+                    row.gbps[0] > 0 ? best / row.gbps[0] : 0);
+    }
+    return 0;
+}
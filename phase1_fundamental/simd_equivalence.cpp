@@ -0,0 +1,120 @@
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simd_kernels.h"
+
+// Checks every SSE2 and AVX2 kernel in simd_kernels.h against the scalar
+// one, and format_int against snprintf. Spans of 0 to 299 ints (so every
+// vector body plus scalar tail split is hit), starting aligned and one int
+// off, filled with full-range random values, values clustered at INT_MIN
+// and INT_MAX, and small values. An Isa this CPU lacks falls back, so it
+// is reported and not counted. test_simd.sh builds and runs it.
+
+static int failures = 0;
+static long checks = 0;
+
+static void fail(const std::string& what) {
+    if (failures++ < 10) {
+        std::printf("FAILED: %s\n", what.c_str());
+    }
+}
+
+static std::vector<int> fill(std::mt19937& rng, size_t size, int pattern) {
+    std::vector<int> values(size + 1);
+    for (int& v : values) {
+        uint32_t bits = rng();
+        switch (pattern) {
+        case 0: v = static_cast<int>(bits); break;
+        case 1: v = (bits & 1) ? INT_MAX - static_cast<int>(bits % 4) : INT_MIN + static_cast<int>(bits % 4); break;
+        default: v = static_cast<int>(bits % 21) - 10; break;
+        }
+    }
+    return values;
+}
+
+static void check_span(const int* data, size_t size, simd::Isa isa, std::mt19937& rng, const std::string& where) {
+    using simd::Compare;
+    const simd::Isa scalar = simd::Isa::Scalar;
+    ++checks;
+
+    if (simd::sum(data, size, isa) != simd::sum(data, size, scalar)) {
+        fail(where + ": sum");
+    }
+    simd::MinMax got = simd::min_max(data, size, isa);
+    simd::MinMax want = simd::min_max(data, size, scalar);
+    if (got.min != want.min || got.max != want.max) {
+        fail(where + ": min_max");
+    }
+
+    int thresholds[] = {INT_MIN, INT_MAX, 0, -1, size ? data[rng() % size] : 5, static_cast<int>(rng())};
+    for (int threshold : thresholds) {
+        for (Compare op : {Compare::Less, Compare::Equal, Compare::Greater}) {
+            if (simd::count(data, size, op, threshold, isa) != simd::count(data, size, op, threshold, scalar)) {
+                fail(where + ": count op " + std::to_string(static_cast<int>(op)) + " threshold "
+                     + std::to_string(threshold));
+            }
+        }
+    }
+
+    int factors[][2] = {{3, 7}, {-1, 0}, {INT_MAX, INT_MIN}, {65537, -65536},
+                        {static_cast<int>(rng()), static_cast<int>(rng())}};
+    std::vector<int> vector_out(size + 1, 0x5a5a5a5a);
+    std::vector<int> scalar_out(size + 1, 0x5a5a5a5a);
+    for (auto& factor : factors) {
+        simd::scale_add(data, vector_out.data(), size, factor[0], factor[1], isa);
+        simd::scale_add(data, scalar_out.data(), size, factor[0], factor[1], scalar);
+        if (vector_out != scalar_out) {
+            fail(where + ": scale_add mul " + std::to_string(factor[0]) + " add " + std::to_string(factor[1]));
+        }
+    }
+}
+
+static void check_format(std::mt19937& rng) {
+    std::vector<int> values = {0, 1, -1, 9, 10, -10, 99, 100, 999999999, 1000000000, INT_MAX, INT_MIN, INT_MIN + 1};
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(static_cast<int>(rng()));
+    }
+    for (int value : values) {
+        char got[simd::MAX_INT_CHARS + 1];
+        char want[32];
+        size_t length = static_cast<size_t>(simd::format_int(value, got) - got);
+        std::snprintf(want, sizeof(want), "%d", value);
+        if (length != std::strlen(want) || std::memcmp(got, want, length) != 0) {
+            fail("format_int(" + std::string(want) + ")");
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(12345);
+    std::string tested;
+    for (simd::Isa isa : {simd::Isa::SSE2, simd::Isa::AVX2}) {
+        if (simd::usable(isa) != isa) {
+            std::printf("%s: not supported by this CPU, skipped\n", simd::isa_name(isa));
+            continue;
+        }
+        tested += std::string(tested.empty() ? "" : ", ") + simd::isa_name(isa);
+        for (size_t size = 0; size < 300; ++size) {
+            for (int pattern = 0; pattern < 3; ++pattern) {
+                std::vector<int> values = fill(rng, size, pattern);
+                for (size_t offset : {size_t(0), size_t(1)}) {
+                    std::string where = std::string(simd::isa_name(isa)) + " size " + std::to_string(size)
+                                        + " pattern " + std::to_string(pattern) + " offset " + std::to_string(offset);
+                    check_span(values.data() + offset, size, isa, rng, where);
+                }
+            }
+        }
+    }
+    check_format(rng);
+    if (failures) {
+        std::printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    std::printf("%ld spans match scalar on %s; format_int matches snprintf\n", checks,
+                tested.empty() ? "no vector ISA" : tested.c_str());
+    return 0;
+}
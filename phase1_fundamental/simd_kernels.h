@@ -0,0 +1,423 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_KERNELS_X86 1
+#endif
+
+// Read-only scans over int arrays, vectorized.
+//
+// Each kernel has a scalar, an SSE2 and an AVX2 version. The vector
+// versions are compiled with per-function target attributes, so the file
+// builds with plain -O2 and the AVX2 code only runs on CPUs that report
+// it (checked once with __builtin_cpu_supports). Every public function
+// takes an optional Isa to force a path, which simd_benchmark.cpp and
+// the equivalence checks in simd_equivalence.cpp (test_simd.sh) use;
+// asking for an Isa the CPU lacks falls back to the best one it has. Off
+// x86 everything is scalar.
+//
+// Arithmetic wraps like unsigned ints (no signed-overflow UB) except
+// sum(), which accumulates in 64 bits.
+namespace simd {
+
+enum class Isa { Scalar, SSE2, AVX2 };
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::AVX2: return "avx2";
+    case Isa::SSE2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+// The widest instruction set this CPU supports.
+inline Isa detected_isa() {
+#ifdef SIMD_KERNELS_X86
+    static const Isa isa = __builtin_cpu_supports("avx2") ? Isa::AVX2
+                         : __builtin_cpu_supports("sse2") ? Isa::SSE2
+                         : Isa::Scalar;
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+inline Isa usable(Isa requested) {
+    Isa best = detected_isa();
+    return static_cast<int>(requested) > static_cast<int>(best) ? best : requested;
+}
+
+struct MinMax {
+    int min = INT_MAX;      // INT_MAX / INT_MIN for an empty span
+    int max = INT_MIN;
+};
+
+enum class Compare { Less, Equal, Greater };
+
+namespace detail {
+
+inline int wrap_scale_add(int x, int mul, int add) {
+    return static_cast<int>(static_cast<uint32_t>(x) * static_cast<uint32_t>(mul) + static_cast<uint32_t>(add));
+}
+
+inline bool compare(int x, Compare op, int threshold) {
+    switch (op) {
+    case Compare::Less: return x < threshold;
+    case Compare::Equal: return x == threshold;
+    default: return x > threshold;
+    }
+}
+
+// ---- scalar ----
+
+inline long long sum_scalar(const int* data, size_t size) {
+    long long total = 0;
+    for (size_t i = 0; i < size; ++i) {
+        total += data[i];
+    }
+    return total;
+}
+
+inline MinMax min_max_scalar(const int* data, size_t size, MinMax acc = MinMax()) {
+    for (size_t i = 0; i < size; ++i) {
+        acc.min = data[i] < acc.min ? data[i] : acc.min;
+        acc.max = data[i] > acc.max ? data[i] : acc.max;
+    }
+    return acc;
+}
+
+inline size_t count_scalar(const int* data, size_t size, Compare op, int threshold) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        count += compare(data[i], op, threshold);
+    }
+    return count;
+}
+
+inline void scale_add_scalar(const int* in, int* out, size_t size, int mul, int add) {
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = wrap_scale_add(in[i], mul, add);
+    }
+}
+
+#ifdef SIMD_KERNELS_X86
+
+// ---- SSE2 ----
+// SSE2 has no 32-bit min/max, sign extension or low multiply (all
+// SSE4.1), so those are built from compares, unpacks and pmuludq.
+
+__attribute__((target("sse2")))
+inline long long hsum_epi64(__m128i v) {
+    long long lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return lanes[0] + lanes[1];
+}
+
+__attribute__((target("sse2")))
+inline long long sum_sse2(const int* data, size_t size) {
+    __m128i acc_lo = _mm_setzero_si128();
+    __m128i acc_hi = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc_lo = _mm_add_epi64(acc_lo, _mm_unpacklo_epi32(v, sign));
+        acc_hi = _mm_add_epi64(acc_hi, _mm_unpackhi_epi32(v, sign));
+    }
+    return hsum_epi64(_mm_add_epi64(acc_lo, acc_hi)) + sum_scalar(data + i, size - i);
+}
+
+__attribute__((target("sse2")))
+inline __m128i select_epi32(__m128i mask, __m128i if_set, __m128i if_clear) {
+    return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+}
+
+__attribute__((target("sse2")))
+inline MinMax min_max_sse2(const int* data, size_t size) {
+    if (size < 4) {
+        return min_max_scalar(data, size);
+    }
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i hi = lo;
+    size_t i = 4;
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        lo = select_epi32(_mm_cmplt_epi32(v, lo), v, lo);
+        hi = select_epi32(_mm_cmpgt_epi32(v, hi), v, hi);
+    }
+    int lows[4];
+    int highs[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lows), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(highs), hi);
+    MinMax acc = min_max_scalar(lows, 4);
+    acc.max = min_max_scalar(highs, 4).max;
+    return min_max_scalar(data + i, size - i, acc);
+}
+
+// Each lane counts at most 2^32 - 1 matches, so the caller splits spans
+// longer than that (see count()).
+template<Compare Op>
+__attribute__((target("sse2")))
+size_t count_sse2(const int* data, size_t size, int threshold) {
+    const __m128i t = _mm_set1_epi32(threshold);
+    __m128i counts = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i match = Op == Compare::Less  ? _mm_cmplt_epi32(v, t)
+                      : Op == Compare::Equal ? _mm_cmpeq_epi32(v, t)
+                      : _mm_cmpgt_epi32(v, t);
+        counts = _mm_sub_epi32(counts, match);   // a match is -1
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), counts);
+    return size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3] + count_scalar(data + i, size - i, Op, threshold);
+}
+
+__attribute__((target("sse2")))
+inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__attribute__((target("sse2")))
+inline void scale_add_sse2(const int* in, int* out, size_t size, int mul, int add) {
+    const __m128i m = _mm_set1_epi32(mul);
+    const __m128i a = _mm_set1_epi32(add);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(mullo_epi32_sse2(v, m), a));
+    }
+    scale_add_scalar(in + i, out + i, size - i, mul, add);
+}
+
+// ---- AVX2 ----
+// Two vectors per iteration so the adds of one don't wait on the other.
+
+__attribute__((target("avx2")))
+inline long long sum_avx2(const int* data, size_t size) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 8));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(a)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(a, 1)));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(b)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(b, 1)));
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return hsum_epi64(half) + sum_sse2(data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+inline MinMax min_max_avx2(const int* data, size_t size) {
+    if (size < 16) {
+        return min_max_sse2(data, size);
+    }
+    __m256i lo0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    __m256i lo1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 8));
+    __m256i hi0 = lo0;
+    __m256i hi1 = lo1;
+    size_t i = 16;
+    for (; i + 16 <= size; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 8));
+        lo0 = _mm256_min_epi32(lo0, a);
+        hi0 = _mm256_max_epi32(hi0, a);
+        lo1 = _mm256_min_epi32(lo1, b);
+        hi1 = _mm256_max_epi32(hi1, b);
+    }
+    int lows[8];
+    int highs[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lows), _mm256_min_epi32(lo0, lo1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(highs), _mm256_max_epi32(hi0, hi1));
+    MinMax acc = min_max_scalar(lows, 8);
+    acc.max = min_max_scalar(highs, 8).max;
+    return min_max_scalar(data + i, size - i, acc);
+}
+
+template<Compare Op>
+__attribute__((target("avx2")))
+size_t count_avx2(const int* data, size_t size, int threshold) {
+    const __m256i t = _mm256_set1_epi32(threshold);
+    __m256i counts = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i match = Op == Compare::Less  ? _mm256_cmpgt_epi32(t, v)
+                      : Op == Compare::Equal ? _mm256_cmpeq_epi32(v, t)
+                      : _mm256_cmpgt_epi32(v, t);
+        counts = _mm256_sub_epi32(counts, match);
+    }
+    uint32_t lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), counts);
+    size_t total = 0;
+    for (uint32_t lane : lanes) {
+        total += lane;
+    }
+    return total + count_scalar(data + i, size - i, Op, threshold);
+}
+
+// The comparison is a template parameter so it is not re-tested per vector.
+template<Compare Op>
+size_t count_x86(const int* data, size_t size, int threshold, Isa isa) {
+    return isa == Isa::AVX2 ? count_avx2<Op>(data, size, threshold) : count_sse2<Op>(data, size, threshold);
+}
+
+__attribute__((target("avx2")))
+inline void scale_add_avx2(const int* in, int* out, size_t size, int mul, int add) {
+    const __m256i m = _mm256_set1_epi32(mul);
+    const __m256i a = _mm256_set1_epi32(add);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(_mm256_mullo_epi32(v, m), a));
+    }
+    scale_add_scalar(in + i, out + i, size - i, mul, add);
+}
+
+#endif // SIMD_KERNELS_X86
+
+// "00".."99", so formatting emits two digits per division.
+inline const char* digit_pairs() {
+    static const char table[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    return table;
+}
+
+} // namespace detail
+
+inline long long sum(const int* data, size_t size, Isa isa = detected_isa()) {
+#ifdef SIMD_KERNELS_X86
+    switch (usable(isa)) {
+    case Isa::AVX2: return detail::sum_avx2(data, size);
+    case Isa::SSE2: return detail::sum_sse2(data, size);
+    default: break;
+    }
+#endif
+    (void)isa;
+    return detail::sum_scalar(data, size);
+}
+
+inline MinMax min_max(const int* data, size_t size, Isa isa = detected_isa()) {
+#ifdef SIMD_KERNELS_X86
+    switch (usable(isa)) {
+    case Isa::AVX2: return detail::min_max_avx2(data, size);
+    case Isa::SSE2: return detail::min_max_sse2(data, size);
+    default: break;
+    }
+#endif
+    (void)isa;
+    return detail::min_max_scalar(data, size);
+}
+
+// Number of elements x with `x op threshold`.
+inline size_t count(const int* data, size_t size, Compare op, int threshold, Isa isa = detected_isa()) {
+#ifdef SIMD_KERNELS_X86
+    // Keep every 32-bit lane counter below 2^32.
+    const size_t BLOCK = size_t(1) << 31;
+    if (size > BLOCK) {
+        return count(data, BLOCK, op, threshold, isa) + count(data + BLOCK, size - BLOCK, op, threshold, isa);
+    }
+    isa = usable(isa);
+    if (isa != Isa::Scalar) {
+        switch (op) {
+        case Compare::Less: return detail::count_x86<Compare::Less>(data, size, threshold, isa);
+        case Compare::Equal: return detail::count_x86<Compare::Equal>(data, size, threshold, isa);
+        default: return detail::count_x86<Compare::Greater>(data, size, threshold, isa);
+        }
+    }
+#endif
+    (void)isa;
+    return detail::count_scalar(data, size, op, threshold);
+}
+
+// Arbitrary predicates stay scalar; the compiler vectorizes simple ones.
+template<typename Predicate>
+size_t count_if(const int* data, size_t size, Predicate pred) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        count += pred(data[i]) ? 1 : 0;
+    }
+    return count;
+}
+
+// out[i] = in[i] * mul + add. `out` may equal `in`, but must not
+// otherwise overlap it.
+inline void scale_add(const int* in, int* out, size_t size, int mul, int add, Isa isa = detected_isa()) {
+#ifdef SIMD_KERNELS_X86
+    switch (usable(isa)) {
+    case Isa::AVX2: detail::scale_add_avx2(in, out, size, mul, add); return;
+    case Isa::SSE2: detail::scale_add_sse2(in, out, size, mul, add); return;
+    default: break;
+    }
+#endif
+    (void)isa;
+    detail::scale_add_scalar(in, out, size, mul, add);
+}
+
+template<typename F>
+void transform(const int* in, int* out, size_t size, F f) {
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = f(in[i]);
+    }
+}
+
+// Longest text of one int ("-2147483648").
+constexpr size_t MAX_INT_CHARS = 11;
+
+// Writes `value` in decimal at `out` (no terminator); returns the end.
+inline char* format_int(int value, char* out) {
+    uint32_t magnitude = static_cast<uint32_t>(value);
+    if (value < 0) {
+        *out++ = '-';
+        magnitude = 0u - magnitude;
+    }
+    char digits[10];
+    char* p = digits + sizeof(digits);
+    const char* pairs = detail::digit_pairs();
+    while (magnitude >= 100) {
+        uint32_t pair = magnitude % 100;
+        magnitude /= 100;
+        p -= 2;
+        std::memcpy(p, pairs + 2 * pair, 2);
+    }
+    if (magnitude >= 10) {
+        p -= 2;
+        std::memcpy(p, pairs + 2 * magnitude, 2);
+    } else {
+        *--p = static_cast<char>('0' + magnitude);
+    }
+    size_t length = digits + sizeof(digits) - p;
+    std::memcpy(out, p, length);
+    return out + length;
+}
+
+// Bytes format_ints() may write for `size` values.
+constexpr size_t format_ints_capacity(size_t size) { return size * (MAX_INT_CHARS + 1); }
+
+// Each value followed by `separator`, into a buffer of at least
+// format_ints_capacity(size) bytes. Returns the number of bytes written.
+inline size_t format_ints(const int* data, size_t size, char* out, char separator = ' ') {
+    char* p = out;
+    for (size_t i = 0; i < size; ++i) {
+        p = format_int(data[i], p);
+        *p++ = separator;
+    }
+    return p - out;
+}
+
+} // namespace simd
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#ifdef POOL_DEBUG
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sanitizer/asan_interface.h>
+#ifdef __SANITIZE_ADDRESS__
+#include <sanitizer/common_interface_defs.h>
+#endif
+#endif
+
+// Freed blocks a POOL_DEBUG build holds back before reusing them.
+#ifndef POOL_DEBUG_QUARANTINE
+#define POOL_DEBUG_QUARANTINE 64
+#endif
+
+// Fixed-size block pool that grows one chunk at a time.
+//
+// - Chunks are never moved or freed while the pool is alive, so growing the
+//   pool never invalidates pointers that were already handed out.
+// - Free blocks are threaded into a singly linked list through their own
+//   storage, so a free slot costs no memory beyond the slot itself.
+// - A new chunk is carved lazily with a bump pointer: allocate() is either a
+//   free-list pop or a pointer bump, never a loop over the chunk.
+// - Chunks come from an upstream memory_resource (operator new by default)
+//   and double in size up to max_chunk_blocks.
+//
+// A pool hides use-after-free and double free from AddressSanitizer, since
+// deallocate() just relinks the block. Building with -DPOOL_DEBUG brings the
+// checks back (without it none of this is compiled in):
+// - freed blocks are filled with 0xDD and, under ASan, poisoned, as is the
+//   padding past the requested size and the not yet carved part of a chunk;
+// - freed blocks wait in a FIFO quarantine of POOL_DEBUG_QUARANTINE blocks
+//   before reuse, and one that was written to meanwhile is reported when it
+//   leaves, which catches late writes even without ASan;
+// - a double free, or freeing a pointer this pool never handed out, aborts
+//   with a message.
+class FixedPool {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Header at the start of every chunk; chunks form an intrusive list too.
+    struct Chunk {
+        Chunk* next;
+        size_t bytes;
+#ifdef POOL_DEBUG
+        size_t blocks;           // one state byte per block follows the last block
+#endif
+    };
+
+    static constexpr size_t MAX_CHUNK_BLOCKS = 64 * 1024;
+
+#ifdef POOL_DEBUG
+    static constexpr size_t STATE_BYTES_PER_BLOCK = 1;
+    static constexpr unsigned char FREED_FILL = 0xDD;
+    static constexpr unsigned char BLOCK_FREE = 0;
+    static constexpr unsigned char BLOCK_LIVE = 1;
+#else
+    static constexpr size_t STATE_BYTES_PER_BLOCK = 0;
+#endif
+
+    size_t block_size;
+    size_t block_align;
+    size_t header_size;          // sizeof(Chunk) rounded up to block_align
+    size_t next_chunk_blocks;
+    size_t max_chunk_blocks;
+    std::pmr::memory_resource* upstream;
+
+    FreeBlock* free_list = nullptr;
+    char* bump = nullptr;        // next never-used block in the newest chunk
+    char* bump_end = nullptr;
+    Chunk* chunks = nullptr;
+
+    size_t capacity_blocks = 0;
+    size_t live_blocks = 0;
+    size_t chunk_bytes = 0;
+
+#ifdef POOL_DEBUG
+    size_t object_size;          // bytes the caller asked for; the rest stays poisoned
+    FreeBlock* quarantine_head = nullptr;   // oldest freed block
+    FreeBlock* quarantine_tail = nullptr;
+    size_t quarantined = 0;
+#endif
+
+    static size_t round_up(size_t n, size_t align) {
+        return (n + align - 1) / align * align;
+    }
+
+    // Slow path: one upstream allocation, no per-block work.
+    void grow(size_t blocks) {
+        size_t bytes = header_size + blocks * (block_size + STATE_BYTES_PER_BLOCK);
+        void* raw = upstream->allocate(bytes, block_align);
+
+        Chunk* chunk = static_cast<Chunk*>(raw);
+        chunk->next = chunks;
+        chunk->bytes = bytes;
+        chunks = chunk;
+#ifdef POOL_DEBUG
+        chunk->blocks = blocks;
+        std::memset(block_states(chunk), BLOCK_FREE, blocks);
+        poison(static_cast<char*>(raw) + header_size, blocks * block_size);
+#endif
+
+        // Whatever was left of the previous chunk goes onto the free list so
+        // it is not lost when the bump pointer moves on.
+        while (bump != bump_end) {
+            push_free(bump);
+            bump += block_size;
+        }
+
+        bump = static_cast<char*>(raw) + header_size;
+        bump_end = bump + blocks * block_size;
+        capacity_blocks += blocks;
+        chunk_bytes += bytes;
+    }
+
+    void push_free(void* ptr) {
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        unpoison(block, sizeof(FreeBlock));
+        block->next = free_list;
+        free_list = block;
+        poison(block, sizeof(FreeBlock));
+    }
+
+    // ASan annotations; no-ops unless POOL_DEBUG is set and ASan is on.
+    static void poison(void* ptr, size_t bytes) {
+#ifdef POOL_DEBUG
+        ASAN_POISON_MEMORY_REGION(ptr, bytes);
+#else
+        (void)ptr;
+        (void)bytes;
+#endif
+    }
+
+    static void unpoison(void* ptr, size_t bytes) {
+#ifdef POOL_DEBUG
+        ASAN_UNPOISON_MEMORY_REGION(ptr, bytes);
+#else
+        (void)ptr;
+        (void)bytes;
+#endif
+    }
+
+#ifdef POOL_DEBUG
+    unsigned char* block_states(Chunk* chunk) const {
+        return reinterpret_cast<unsigned char*>(chunk) + header_size + chunk->blocks * block_size;
+    }
+
+    [[noreturn]] void fail(const char* what, const void* ptr) const {
+        std::fprintf(stderr, "FixedPool (block size %zu): %s at %p\n", block_size, what, ptr);
+#ifdef __SANITIZE_ADDRESS__
+        __sanitizer_print_stack_trace();
+#endif
+        std::abort();
+    }
+
+    // State byte of the block starting at `ptr`; aborts if there is none.
+    unsigned char& block_state(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        for (Chunk* chunk = chunks; chunk; chunk = chunk->next) {
+            const char* first = reinterpret_cast<const char*>(chunk) + header_size;
+            if (p < first || p >= first + chunk->blocks * block_size) {
+                continue;
+            }
+            size_t offset = static_cast<size_t>(p - first);
+            if (offset % block_size != 0) {
+                fail("pointer into the middle of a block", ptr);
+            }
+            return block_states(chunk)[offset / block_size];
+        }
+        fail("pointer not allocated from this pool", ptr);
+    }
+
+    void mark_live(void* ptr) {
+        block_state(ptr) = BLOCK_LIVE;
+        unpoison(ptr, object_size);
+    }
+
+    // Frees into the quarantine; the oldest quarantined block moves on to
+    // the free list once the quarantine is full.
+    void quarantine(void* ptr) {
+        unsigned char& state = block_state(ptr);
+        if (state != BLOCK_LIVE) {
+            fail("double free", ptr);
+        }
+        state = BLOCK_FREE;
+
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        unpoison(block, block_size);
+        std::memset(block, FREED_FILL, block_size);
+        block->next = nullptr;
+        poison(block, block_size);
+        if (quarantine_tail) {
+            unpoison(quarantine_tail, sizeof(FreeBlock));
+            quarantine_tail->next = block;
+            poison(quarantine_tail, sizeof(FreeBlock));
+        } else {
+            quarantine_head = block;
+        }
+        quarantine_tail = block;
+        if (++quarantined <= POOL_DEBUG_QUARANTINE) {
+            return;
+        }
+
+        FreeBlock* oldest = quarantine_head;
+        unpoison(oldest, block_size);
+        quarantine_head = oldest->next;
+        if (!quarantine_head) {
+            quarantine_tail = nullptr;
+        }
+        --quarantined;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(oldest);
+        for (size_t i = sizeof(FreeBlock); i < block_size; ++i) {
+            if (bytes[i] != FREED_FILL) {
+                fail("freed block was written to while in quarantine (use after free)", oldest);
+            }
+        }
+        poison(oldest, block_size);
+        push_free(oldest);
+    }
+#endif
+
+    void release_chunks() {
+        while (chunks) {
+            Chunk* next = chunks->next;
+            // Hand the memory back clean; upstream may reuse it unpoisoned.
+            unpoison(chunks, chunks->bytes);
+            upstream->deallocate(chunks, chunks->bytes, block_align);
+            chunks = next;
+        }
+    }
+
+public:
+    FixedPool(size_t size, size_t align = alignof(std::max_align_t),
+              size_t first_chunk_blocks = 1024,
+              std::pmr::memory_resource* upstream_resource = std::pmr::new_delete_resource(),
+              size_t chunk_blocks_limit = MAX_CHUNK_BLOCKS)
+        : block_align(std::max(align, alignof(FreeBlock))),
+          next_chunk_blocks(std::max<size_t>(first_chunk_blocks, 1)),
+          max_chunk_blocks(std::max(chunk_blocks_limit, next_chunk_blocks)),
+          upstream(upstream_resource) {
+        block_size = round_up(std::max(size, sizeof(FreeBlock)), block_align);
+        header_size = chunk_overhead(block_align);
+#ifdef POOL_DEBUG
+        object_size = size;
+#endif
+    }
+
+    // Bytes at the start of every chunk that do not hold blocks.
+    static size_t chunk_overhead(size_t align) {
+        return round_up(sizeof(Chunk), std::max(align, alignof(FreeBlock)));
+    }
+
+    // How many `size`-byte blocks fit in a chunk of `chunk_bytes` bytes,
+    // for callers that hand out fixed-size chunks.
+    static size_t blocks_per_chunk(size_t chunk_bytes, size_t size, size_t align) {
+        align = std::max(align, alignof(FreeBlock));
+        size_t block = round_up(std::max(size, sizeof(FreeBlock)), align);
+        return (chunk_bytes - chunk_overhead(align)) / (block + STATE_BYTES_PER_BLOCK);
+    }
+
+    ~FixedPool() { release_chunks(); }
+
+    FixedPool(const FixedPool&) = delete;
+    FixedPool& operator=(const FixedPool&) = delete;
+
+    FixedPool(FixedPool&& other) noexcept
+        : block_size(other.block_size),
+          block_align(other.block_align),
+          header_size(other.header_size),
+          next_chunk_blocks(other.next_chunk_blocks),
+          max_chunk_blocks(other.max_chunk_blocks),
+          upstream(other.upstream),
+          free_list(std::exchange(other.free_list, nullptr)),
+          bump(std::exchange(other.bump, nullptr)),
+          bump_end(std::exchange(other.bump_end, nullptr)),
+          chunks(std::exchange(other.chunks, nullptr)),
+          capacity_blocks(std::exchange(other.capacity_blocks, 0)),
+          live_blocks(std::exchange(other.live_blocks, 0)),
+          chunk_bytes(std::exchange(other.chunk_bytes, 0))
+#ifdef POOL_DEBUG
+          , object_size(other.object_size),
+          quarantine_head(std::exchange(other.quarantine_head, nullptr)),
+          quarantine_tail(std::exchange(other.quarantine_tail, nullptr)),
+          quarantined(std::exchange(other.quarantined, 0))
+#endif
+    {}
+
+    FixedPool& operator=(FixedPool&&) = delete;
+
+    void* allocate() {
+        if (free_list) {
+            FreeBlock* block = free_list;
+            unpoison(block, sizeof(FreeBlock));
+            free_list = block->next;
+            ++live_blocks;
+#ifdef POOL_DEBUG
+            mark_live(block);
+#endif
+            return block;
+        }
+        if (bump == bump_end) {
+            grow(next_chunk_blocks);
+            next_chunk_blocks = std::min(next_chunk_blocks * 2, max_chunk_blocks);
+        }
+        void* ptr = bump;
+        bump += block_size;
+        ++live_blocks;
+#ifdef POOL_DEBUG
+        mark_live(ptr);
+#endif
+        return ptr;
+    }
+
+    void deallocate(void* ptr) {
+#ifdef POOL_DEBUG
+        quarantine(ptr);
+#else
+        push_free(ptr);
+#endif
+        --live_blocks;
+    }
+
+    // Grow ahead of time so that the next `blocks` allocations never reach
+    // the upstream allocator.
+    void reserve(size_t blocks) {
+        size_t free_blocks = available_count();
+        while (blocks > free_blocks) {
+            size_t step = std::min(blocks - free_blocks, max_chunk_blocks);
+            grow(step);
+            free_blocks += step;
+        }
+    }
+
+    // Frees every block at once by handing all chunks back upstream:
+    // O(chunks), not O(blocks). Objects still in the blocks are not
+    // destroyed, and every pointer from this pool becomes invalid.
+    void release() {
+        release_chunks();
+        free_list = nullptr;
+        bump = nullptr;
+        bump_end = nullptr;
+        capacity_blocks = 0;
+        live_blocks = 0;
+        chunk_bytes = 0;
+#ifdef POOL_DEBUG
+        quarantine_head = nullptr;
+        quarantine_tail = nullptr;
+        quarantined = 0;
+#endif
+    }
+
+    size_t size() const { return block_size; }
+    size_t alignment() const { return block_align; }
+    size_t capacity() const { return capacity_blocks; }
+    size_t live_count() const { return live_blocks; }
+    // Blocks allocate() can hand out before the pool has to grow.
+    size_t available_count() const { return capacity_blocks - live_blocks - quarantined_count(); }
+
+    // Freed blocks held back from reuse; always 0 without POOL_DEBUG.
+    size_t quarantined_count() const {
+#ifdef POOL_DEBUG
+        return quarantined;
+#else
+        return 0;
+#endif
+    }
+
+    // Bytes obtained from upstream, chunk headers included.
+    size_t footprint_bytes() const { return chunk_bytes; }
+};
+
+// Typed facade over FixedPool.
+//
+// allocate() hands out uninitialized storage for one T: construct it with
+// placement new (or assign, for trivial types) and destroy it before calling
+// deallocate(). The pool starts with room for POOL_SIZE objects and grows
+// on demand instead of throwing.
+template<typename T>
+class SimplePool {
+private:
+    static constexpr size_t POOL_SIZE = 1024;
+    FixedPool pool;
+
+public:
+    explicit SimplePool(size_t first_chunk = POOL_SIZE)
+        : pool(sizeof(T), alignof(T), first_chunk) {}
+
+    T* allocate() {
+        return static_cast<T*>(pool.allocate());
+    }
+
+    void deallocate(T* ptr) {
+        pool.deallocate(ptr);
+    }
+
+    void reserve(size_t count) { pool.reserve(count); }
+
+    size_t available_count() const { return pool.available_count(); }
+    size_t capacity() const { return pool.capacity(); }
+    size_t live_count() const { return pool.live_count(); }
+    size_t slot_size() const { return pool.size(); }
+    size_t footprint_bytes() const { return pool.footprint_bytes(); }
+};
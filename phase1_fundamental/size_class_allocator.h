@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+
+#include "simple_pool.h"
+
+// Multi-size allocator built from one FixedPool per size class.
+//
+// Size classes follow jemalloc's spacing: 16-byte steps up to 128, then four
+// classes per power of two up to MAX_SMALL (160, 192, 224, 256, 320, ...).
+// Every pool chunk is one SPAN_SIZE-aligned span from mmap with a small
+// header at its start, so deallocate() finds a block's class by masking the
+// pointer; no per-block header is needed. Requests above MAX_SMALL get their
+// own aligned mapping with the same header and are unmapped on free.
+//
+// Nothing here calls operator new, so the allocator can back a global
+// operator new/delete replacement (see SIZE_CLASS_OVERRIDE_NEW below).
+
+// Lock policy for single-threaded use.
+struct NullMutex {
+    void lock() {}
+    void unlock() {}
+};
+
+template<typename Mutex = NullMutex>
+class SizeClassAllocator {
+private:
+    static constexpr size_t SPAN_SIZE = 64 * 1024;
+    static constexpr size_t SPAN_HEADER = 64;
+    static constexpr size_t BLOCK_ALIGN = 16;
+    static constexpr size_t MAX_SMALL = 4096;
+    static constexpr size_t NUM_CLASSES = 8 + 4 * 5;    // 16..128, then 5 doublings
+    static constexpr uint32_t SPAN_MAGIC = 0x5a5c1a55;
+    static constexpr uint32_t LARGE_CLASS = 0xffffffff;
+
+    struct SpanHeader {
+        uint32_t magic;
+        uint32_t class_index;
+        size_t mapping_bytes;
+    };
+
+    // Hands FixedPool one span per chunk, tagged with the pool's class.
+    class SpanResource final : public std::pmr::memory_resource {
+    private:
+        uint32_t class_index = 0;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t) override {
+            if (bytes > SPAN_SIZE - SPAN_HEADER) {
+                throw std::bad_alloc();
+            }
+            char* span = map_aligned(SPAN_SIZE);
+            new (span) SpanHeader{SPAN_MAGIC, class_index, SPAN_SIZE};
+            return span + SPAN_HEADER;
+        }
+
+        void do_deallocate(void* ptr, size_t, size_t) override {
+            munmap(static_cast<char*>(ptr) - SPAN_HEADER, SPAN_SIZE);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    public:
+        explicit SpanResource(uint32_t index) : class_index(index) {}
+    };
+
+    // Raw storage so that constructing the allocator never allocates.
+    alignas(SpanResource) unsigned char span_storage[NUM_CLASSES][sizeof(SpanResource)];
+    alignas(FixedPool) unsigned char pool_storage[NUM_CLASSES][sizeof(FixedPool)];
+    Mutex mutex;
+
+    SpanResource& span_resource(size_t index) {
+        return *std::launder(reinterpret_cast<SpanResource*>(span_storage[index]));
+    }
+
+    FixedPool& pool(size_t index) {
+        return *std::launder(reinterpret_cast<FixedPool*>(pool_storage[index]));
+    }
+
+    // mmap `bytes` (a multiple of SPAN_SIZE) at a SPAN_SIZE-aligned address
+    // by over-mapping and trimming both ends.
+    static char* map_aligned(size_t bytes) {
+        size_t padded = bytes + SPAN_SIZE;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        uintptr_t base = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (base + SPAN_SIZE - 1) & ~(SPAN_SIZE - 1);
+        size_t head = aligned - base;
+        size_t tail = padded - head - bytes;
+        if (head) {
+            munmap(raw, head);
+        }
+        if (tail) {
+            munmap(reinterpret_cast<char*>(aligned + bytes), tail);
+        }
+        return reinterpret_cast<char*>(aligned);
+    }
+
+    static SpanHeader* header_of(void* ptr) {
+        uintptr_t span = reinterpret_cast<uintptr_t>(ptr) & ~(SPAN_SIZE - 1);
+        SpanHeader* header = reinterpret_cast<SpanHeader*>(span);
+        if (header->magic != SPAN_MAGIC) {
+            std::abort();   // not ours: freeing it would corrupt a pool
+        }
+        return header;
+    }
+
+    void* allocate_large(size_t bytes) {
+        size_t mapping = (bytes + SPAN_HEADER + SPAN_SIZE - 1) & ~(SPAN_SIZE - 1);
+        char* base = map_aligned(mapping);
+        new (base) SpanHeader{SPAN_MAGIC, LARGE_CLASS, mapping};
+        return base + SPAN_HEADER;
+    }
+
+public:
+    static size_t class_index(size_t bytes) {
+        if (bytes <= 128) {
+            return bytes == 0 ? 0 : (bytes - 1) / 16;
+        }
+        size_t top_bit = 63 - static_cast<size_t>(__builtin_clzl(bytes - 1));
+        size_t base = size_t(1) << top_bit;
+        return 8 + (top_bit - 7) * 4 + (bytes - 1 - base) / (base / 4);
+    }
+
+    static size_t class_size(size_t index) {
+        if (index < 8) {
+            return (index + 1) * 16;
+        }
+        size_t base = size_t(128) << ((index - 8) / 4);
+        return base + ((index - 8) % 4 + 1) * (base / 4);
+    }
+
+    SizeClassAllocator() {
+        for (size_t i = 0; i < NUM_CLASSES; ++i) {
+            size_t size = class_size(i);
+            size_t blocks = FixedPool::blocks_per_chunk(SPAN_SIZE - SPAN_HEADER, size, BLOCK_ALIGN);
+            auto* resource = new (span_storage[i]) SpanResource(static_cast<uint32_t>(i));
+            new (pool_storage[i]) FixedPool(size, BLOCK_ALIGN, blocks, resource, blocks);
+        }
+    }
+
+    ~SizeClassAllocator() {
+        for (size_t i = 0; i < NUM_CLASSES; ++i) {
+            pool(i).~FixedPool();
+            span_resource(i).~SpanResource();
+        }
+    }
+
+    SizeClassAllocator(const SizeClassAllocator&) = delete;
+    SizeClassAllocator& operator=(const SizeClassAllocator&) = delete;
+
+    void* allocate(size_t bytes) {
+        if (bytes > MAX_SMALL) {
+            return allocate_large(bytes);
+        }
+        std::lock_guard<Mutex> lock(mutex);
+        return pool(class_index(bytes)).allocate();
+    }
+
+    void deallocate(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        SpanHeader* header = header_of(ptr);
+        if (header->class_index == LARGE_CLASS) {
+            munmap(header, header->mapping_bytes);
+            return;
+        }
+        std::lock_guard<Mutex> lock(mutex);
+        pool(header->class_index).deallocate(ptr);
+    }
+
+    // Bytes actually available behind ptr (at least what was requested).
+    static size_t usable_size(void* ptr) {
+        SpanHeader* header = header_of(ptr);
+        if (header->class_index == LARGE_CLASS) {
+            return header->mapping_bytes - SPAN_HEADER;
+        }
+        return class_size(header->class_index);
+    }
+};
+
+// Optional replacement of the global operator new/delete. Define
+// SIZE_CLASS_OVERRIDE_NEW in exactly one translation unit before including
+// this header. The allocator is built in static storage on first use and
+// never destroyed, so frees from late static destructors stay valid.
+// Over-aligned new (align_val_t) is left to the standard library.
+#ifdef SIZE_CLASS_OVERRIDE_NEW
+
+inline SizeClassAllocator<std::mutex>& global_size_class_allocator() {
+    alignas(SizeClassAllocator<std::mutex>) static unsigned char storage[sizeof(SizeClassAllocator<std::mutex>)];
+    static SizeClassAllocator<std::mutex>* instance = new (storage) SizeClassAllocator<std::mutex>();
+    return *instance;
+}
+
+void* operator new(size_t bytes) {
+    return global_size_class_allocator().allocate(bytes);
+}
+
+void* operator new[](size_t bytes) {
+    return global_size_class_allocator().allocate(bytes);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return global_size_class_allocator().allocate(bytes);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return global_size_class_allocator().allocate(bytes);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept { global_size_class_allocator().deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { global_size_class_allocator().deallocate(ptr); }
+void operator delete(void* ptr, size_t) noexcept { global_size_class_allocator().deallocate(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { global_size_class_allocator().deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { global_size_class_allocator().deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { global_size_class_allocator().deallocate(ptr); }
+
+#endif
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// 32-bit generational handle: 24-bit slot index, 8-bit generation.
+//
+// Half the size of a pointer, and a handle to an erased object is detected
+// instead of dangling: erasing bumps the slot's generation, so the old
+// handle no longer matches. Generation 0 is never handed out, which makes
+// the all-zero handle the null handle.
+struct SlotHandle {
+    static constexpr uint32_t INDEX_BITS = 24;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+    uint32_t bits = 0;
+
+    SlotHandle() = default;
+    SlotHandle(uint32_t index, uint32_t generation) : bits(generation << INDEX_BITS | index) {}
+
+    uint32_t index() const { return bits & INDEX_MASK; }
+    uint32_t generation() const { return bits >> INDEX_BITS; }
+
+    explicit operator bool() const { return bits != 0; }
+    friend bool operator==(SlotHandle a, SlotHandle b) { return a.bits == b.bits; }
+    friend bool operator!=(SlotHandle a, SlotHandle b) { return a.bits != b.bits; }
+};
+
+// Slot map: objects addressed by SlotHandle instead of by pointer.
+//
+// - Slots live in fixed chunks of CHUNK_SLOTS that are never moved, so
+//   get() is two array lookups and a generation compare.
+// - A free slot keeps the index of the next free slot in its own storage.
+// - Generations wrap from 255 back to 1, so a slot is reused forever and
+//   a map under steady insert/erase churn keeps a fixed capacity. The
+//   price of 8 bits: a stale handle matches again after its slot has been
+//   reused 255 times, so don't hold handles across that much churn.
+// - At most 2^24 slots; insert() throws std::length_error past that.
+template<typename T>
+class SlotMap {
+private:
+    static constexpr size_t CHUNK_SLOTS = 4096;
+    static constexpr uint32_t MAX_SLOTS = SlotHandle::INDEX_MASK + 1;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+    static constexpr uint8_t LAST_GENERATION = 255;
+
+    struct Slot {
+        alignas(T) unsigned char storage[std::max(sizeof(T), sizeof(uint32_t))];
+        uint8_t generation;     // of the current (or next) occupant
+        bool occupied;
+
+        T* object() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    std::vector<Slot*> chunks;
+    std::pmr::memory_resource* upstream;
+    uint32_t free_head = NO_SLOT;
+    uint32_t used_slots = 0;     // slots ever handed out (the high-water index)
+    size_t live = 0;
+
+    Slot& slot(uint32_t index) const {
+        return chunks[index / CHUNK_SLOTS][index % CHUNK_SLOTS];
+    }
+
+    uint32_t take_slot() {
+        if (free_head != NO_SLOT) {
+            uint32_t index = free_head;
+            std::memcpy(&free_head, slot(index).storage, sizeof(free_head));
+            return index;
+        }
+        if (used_slots == MAX_SLOTS) {
+            throw std::length_error("SlotMap: out of 24-bit slot indices");
+        }
+        if (used_slots % CHUNK_SLOTS == 0) {
+            void* raw = upstream->allocate(CHUNK_SLOTS * sizeof(Slot), alignof(Slot));
+            chunks.push_back(static_cast<Slot*>(raw));
+        }
+        Slot& fresh = slot(used_slots);
+        fresh.generation = 1;
+        fresh.occupied = false;
+        return used_slots++;
+    }
+
+    void release_slot(uint32_t index) {
+        Slot& freed = slot(index);
+        freed.occupied = false;
+        freed.generation = freed.generation == LAST_GENERATION ? uint8_t(1)
+                                                               : static_cast<uint8_t>(freed.generation + 1);
+        std::memcpy(freed.storage, &free_head, sizeof(free_head));
+        free_head = index;
+    }
+
+public:
+    using Handle = SlotHandle;
+
+    explicit SlotMap(std::pmr::memory_resource* upstream_resource = std::pmr::new_delete_resource())
+        : upstream(upstream_resource) {}
+
+    ~SlotMap() {
+        for (uint32_t i = 0; i < used_slots; ++i) {
+            if (slot(i).occupied) {
+                slot(i).object()->~T();
+            }
+        }
+        for (Slot* chunk : chunks) {
+            upstream->deallocate(chunk, CHUNK_SLOTS * sizeof(Slot), alignof(Slot));
+        }
+    }
+
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    template<typename... Args>
+    Handle insert(Args&&... args) {
+        uint32_t index = take_slot();
+        Slot& target = slot(index);
+        try {
+            new (target.storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            std::memcpy(target.storage, &free_head, sizeof(free_head));
+            free_head = index;
+            throw;
+        }
+        target.occupied = true;
+        ++live;
+        return Handle(index, target.generation);
+    }
+
+    // Destroys the object; false if the handle was already stale.
+    bool erase(Handle handle) {
+        T* object = get(handle);
+        if (!object) {
+            return false;
+        }
+        object->~T();
+        release_slot(handle.index());
+        --live;
+        return true;
+    }
+
+    // The object behind `handle`, or nullptr if it has been erased.
+    T* get(Handle handle) const {
+        uint32_t index = handle.index();
+        if (index >= used_slots) {
+            return nullptr;
+        }
+        Slot& target = slot(index);
+        if (!target.occupied || target.generation != handle.generation()) {
+            return nullptr;
+        }
+        return target.object();
+    }
+
+    bool contains(Handle handle) const { return get(handle) != nullptr; }
+
+    size_t size() const { return live; }
+    size_t capacity() const { return chunks.size() * CHUNK_SLOTS; }
+    static constexpr size_t slot_size() { return sizeof(Slot); }
+
+    size_t footprint_bytes() const {
+        return chunks.size() * CHUNK_SLOTS * sizeof(Slot) + chunks.capacity() * sizeof(Slot*);
+    }
+};
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <malloc.h>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_harness.h"
+#include "slot_map.h"
+
+// The Node from leak_creation.cpp: value plus two raw pointers.
+struct RawNode {
+    int value;
+    RawNode* next;
+    RawNode* prev;
+
+    explicit RawNode(int v) : value(v), next(nullptr), prev(nullptr) {}
+};
+
+// The Node from real_circular_leak.cpp, without the destructor message.
+struct SharedNode {
+    int value;
+    std::shared_ptr<SharedNode> next;
+    std::weak_ptr<SharedNode> prev;
+
+    explicit SharedNode(int v) : value(v) {}
+};
+
+// The same links as 32-bit handles into a SlotMap.
+struct HandleNode {
+    int value;
+    SlotHandle next;
+    SlotHandle prev;
+
+    explicit HandleNode(int v) : value(v) {}
+};
+
+class HandleBenchmark {
+public:
+    static size_t residentBytes() {
+        long pages = 0;
+        long resident = 0;
+        FILE* statm = std::fopen("/proc/self/statm", "r");
+        if (statm) {
+            if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+                resident = 0;
+            }
+            std::fclose(statm);
+        }
+        return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    static size_t heapBytes() {
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+    }
+
+    struct Footprint {
+        double heap_per_node;
+        double rss_mb;
+    };
+
+    // Heap bytes per node and RSS growth while `build` holds its graph.
+    template<typename Build>
+    static Footprint measure(int n, Build build) {
+        malloc_trim(0);
+        size_t heap_before = heapBytes();
+        size_t rss_before = residentBytes();
+        auto graph = build();
+        Footprint result{static_cast<double>(heapBytes() - heap_before) / n,
+                         static_cast<double>(residentBytes() - rss_before) / (1024 * 1024)};
+        bench::DoNotOptimize(graph);
+        return result;
+    }
+
+    static void compare(bench::Suite& suite, int n) {
+        std::cout << "\n=== " << n << " nodes, linked in shuffled order ===\n";
+        const std::string suffix = " n=" + std::to_string(n);
+
+        // Nodes are allocated in index order but linked in a random order,
+        // so traversal jumps around memory the way a real graph does.
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+        auto build_raw = [&] {
+            std::vector<RawNode*> nodes(n);
+            for (int i = 0; i < n; ++i) {
+                nodes[i] = new RawNode(i);
+            }
+            for (int i = 0; i + 1 < n; ++i) {
+                nodes[order[i]]->next = nodes[order[i + 1]];
+                nodes[order[i + 1]]->prev = nodes[order[i]];
+            }
+            RawNode* head = nodes[order[0]];
+            return std::unique_ptr<RawNode, void (*)(RawNode*)>(head, [](RawNode* node) {
+                while (node) {
+                    RawNode* next = node->next;
+                    delete node;
+                    node = next;
+                }
+            });
+        };
+        auto build_shared = [&] {
+            std::vector<std::shared_ptr<SharedNode>> nodes(n);
+            for (int i = 0; i < n; ++i) {
+                nodes[i] = std::make_shared<SharedNode>(i);
+            }
+            for (int i = 0; i + 1 < n; ++i) {
+                nodes[order[i]]->next = nodes[order[i + 1]];
+                nodes[order[i + 1]]->prev = nodes[order[i]];
+            }
+            // Unlink iteratively on destruction; a long shared_ptr chain
+            // would otherwise be destroyed recursively.
+            return std::shared_ptr<SharedNode>(nodes[order[0]].get(),
+                [head = nodes[order[0]]](SharedNode*) mutable {
+                    while (head) {
+                        head = std::move(head->next);
+                    }
+                });
+        };
+        auto build_handles = [&] {
+            auto map = std::make_unique<SlotMap<HandleNode>>();
+            std::vector<SlotHandle> handles(n);
+            for (int i = 0; i < n; ++i) {
+                handles[i] = map->insert(i);
+            }
+            for (int i = 0; i + 1 < n; ++i) {
+                map->get(handles[order[i]])->next = handles[order[i + 1]];
+                map->get(handles[order[i + 1]])->prev = handles[order[i]];
+            }
+            return std::make_pair(std::move(map), handles[order[0]]);
+        };
+
+        Footprint raw_bytes = measure(n, build_raw);
+        Footprint shared_bytes = measure(n, build_shared);
+        Footprint handle_bytes = measure(n, build_handles);
+
+        auto raw = build_raw();
+        auto raw_result = suite.run_once("raw pointer traverse" + suffix, [&] {
+            long sum = 0;
+            for (RawNode* node = raw.get(); node; node = node->next) {
+                sum += node->value;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+        raw.reset();
+
+        auto shared = build_shared();
+        auto shared_result = suite.run_once("shared_ptr traverse" + suffix, [&] {
+            long sum = 0;
+            for (SharedNode* node = shared.get(); node; node = node->next.get()) {
+                sum += node->value;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+        shared.reset();
+
+        auto handles = build_handles();
+        auto handle_result = suite.run_once("SlotMap handle traverse" + suffix, [&] {
+            long sum = 0;
+            for (SlotHandle h = handles.second; h;) {
+                HandleNode* node = handles.first->get(h);
+                sum += node->value;
+                h = node->next;
+            }
+            bench::DoNotOptimize(sum);
+        }, n);
+
+        std::cout << "design       heap B/node  nodes/64B line  RSS MB  ns/hop\n";
+        auto row = [](const char* name, Footprint f, const bench::Result& r) {
+            std::printf("%-12s %11.1f %15.2f %7.1f %7.2f\n", name, f.heap_per_node,
+                        64.0 / f.heap_per_node, f.rss_mb, r.median);
+        };
+        row("raw pointer", raw_bytes, raw_result);
+        row("shared_ptr", shared_bytes, shared_result);
+        row("SlotMap", handle_bytes, handle_result);
+        std::cout.flush();
+    }
+
+    // The circularLeak hazard from leak_creation.cpp: with raw pointers a
+    // neighbour of a deleted node dangles; with handles it goes stale.
+    static void staleHandleDemo() {
+        SlotMap<HandleNode> map;
+        SlotHandle node1 = map.insert(1);
+        SlotHandle node2 = map.insert(2);
+        map.get(node1)->next = node2;
+        map.get(node2)->prev = node1;
+        map.get(node2)->next = node1;   // circular
+        map.get(node1)->prev = node2;
+
+        map.erase(node1);
+        SlotHandle dangling = map.get(node2)->next;
+        std::cout << "\nAfter erasing node1, node2->next resolves to "
+                  << (map.get(dangling) ? "a live node (BUG)" : "nullptr (stale handle detected)") << "\n";
+
+        SlotHandle reused = map.insert(3);   // same slot, new generation
+        std::cout << "Slot reused for node3: index " << reused.index() << " generation "
+                  << reused.generation() << "; old handle still "
+                  << (map.get(dangling) ? "resolves (BUG)" : "stale") << "\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    int max_nodes = 10000000;
+    if (argc > 1 && argv[1][0] != '-') {
+        max_nodes = std::atoi(argv[1]);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 5;
+    bench::Suite suite("slot_map_benchmark", argc, argv, options);
+
+    std::cout << "SlotMap slot: " << SlotMap<HandleNode>::slot_size() << " bytes, raw node: "
+              << sizeof(RawNode) << " bytes, shared node: " << sizeof(SharedNode) << " bytes\n";
+    for (int n = 10000; n <= max_nodes; n *= 10) {
+        HandleBenchmark::compare(suite, n);
+    }
+    HandleBenchmark::staleHandleDemo();
+    return 0;
+}
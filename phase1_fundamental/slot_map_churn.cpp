@@ -0,0 +1,55 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "slot_map.h"
+
+// Steady insert/erase churn must not grow a SlotMap: erased slots come
+// back through the free list however often they are reused, so capacity
+// and footprint stay at what the peak live count needs. Also checks that
+// every erased handle goes stale and every live one still resolves.
+// test_slot_map.sh builds and runs it. Optional args: ops live_objects.
+
+int main(int argc, char** argv) {
+    long ops = argc > 1 ? std::atol(argv[1]) : 10000000;
+    int live_objects = argc > 2 ? std::atoi(argv[2]) : 1;
+
+    SlotMap<std::string> map;
+    std::vector<SlotHandle> live;
+    for (int i = 0; i < live_objects; ++i) {
+        live.push_back(map.insert(std::to_string(i)));
+    }
+    const size_t capacity = map.capacity();
+    const size_t footprint = map.footprint_bytes();
+
+    int failures = 0;
+    for (long op = 0; op < ops; ++op) {
+        size_t victim = static_cast<size_t>(op) % live.size();
+        SlotHandle old = live[victim];
+        map.erase(old);
+        live[victim] = map.insert(std::to_string(op));
+        if (map.get(old) || !map.get(live[victim]) || *map.get(live[victim]) != std::to_string(op)) {
+            if (failures++ < 5) {
+                std::cout << "stale or missing handle at op " << op << "\n";
+            }
+        }
+    }
+    if (map.size() != live.size()) {
+        std::cout << "size " << map.size() << ", expected " << live.size() << "\n";
+        ++failures;
+    }
+    if (map.capacity() != capacity || map.footprint_bytes() != footprint) {
+        std::cout << "grew under churn: capacity " << capacity << " -> " << map.capacity()
+                  << ", footprint " << footprint << " -> " << map.footprint_bytes() << " bytes\n";
+        ++failures;
+    }
+    if (failures) {
+        std::cout << "FAILED\n";
+        return 1;
+    }
+    std::cout << ops << " erase/insert pairs over " << live.size()
+              << (live.size() == 1 ? " live object" : " live objects") << ": capacity "
+              << map.capacity() << ", " << map.footprint_bytes() << " bytes, unchanged\n";
+    return 0;
+}
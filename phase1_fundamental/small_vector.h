@@ -0,0 +1,409 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Vector with room for N elements inside the object.
+//
+// Up to N elements live in inline storage, so a short small_vector on the
+// stack never touches the heap; growing past N moves everything to
+// storage from a std::pmr::memory_resource (operator new by default, or a
+// PoolResource or ArenaResource). Capacity doubles from there like
+// std::vector's. Copies get the default resource, as std::pmr containers
+// do; moves keep the source's.
+//
+// Exception safety matches std::vector: push_back, emplace_back, reserve,
+// resize and copy assignment either succeed or leave the vector
+// unchanged. Elements are moved to new storage only if their move
+// constructor is noexcept (or they can't be copied); otherwise they are
+// copied, so a throw leaves the originals in place. Move assignment only
+// gives the basic guarantee (see below). Iterators are pointers and are
+// invalidated by any reallocation, including the spill out of inline
+// storage. small_vector_exceptions.cpp checks all of this.
+template<typename T, size_t N>
+class small_vector {
+    static_assert(N > 0, "use std::vector for no inline capacity");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+
+private:
+    T* first;
+    size_t count = 0;
+    size_t cap = N;
+    std::pmr::memory_resource* resource;
+    alignas(T) unsigned char inline_storage[N * sizeof(T)];
+
+    T* inline_data() { return std::launder(reinterpret_cast<T*>(inline_storage)); }
+    const T* inline_data() const { return std::launder(reinterpret_cast<const T*>(inline_storage)); }
+
+    static constexpr bool move_relocates = std::is_nothrow_move_constructible_v<T>
+                                           || !std::is_copy_constructible_v<T>;
+
+    // Constructs [from, from + n) into raw storage at `to`: moves when that
+    // can't throw, copies otherwise. On a throw nothing is left constructed.
+    static void relocate(T* from, size_t n, T* to) {
+        if constexpr (move_relocates) {
+            std::uninitialized_move(from, from + n, to);
+        } else {
+            std::uninitialized_copy(from, from + n, to);
+        }
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void release_storage() {
+        if (first != inline_data()) {
+            resource->deallocate(first, cap * sizeof(T), alignof(T));
+        }
+    }
+
+    size_t grown_capacity(size_t needed) const {
+        if (needed > max_size()) {
+            throw std::length_error("small_vector too long");
+        }
+        return std::max(needed, cap > max_size() / 2 ? max_size() : cap * 2);
+    }
+
+    // Switches to `storage` (capacity `new_cap`) holding the same elements.
+    void adopt(T* storage, size_t new_cap) {
+        std::destroy(first, first + count);
+        release_storage();
+        first = storage;
+        cap = new_cap;
+    }
+
+    // Reallocates and constructs one element from args at the end. The new
+    // element is built before the old ones move, so args may refer to them.
+    template<typename... Args>
+    T& grow_and_emplace(Args&&... args) {
+        size_t new_cap = grown_capacity(count + 1);
+        T* storage = allocate(new_cap);
+        T* slot = storage + count;
+        try {
+            ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+            try {
+                relocate(first, count, storage);
+            } catch (...) {
+                slot->~T();
+                throw;
+            }
+        } catch (...) {
+            resource->deallocate(storage, new_cap * sizeof(T), alignof(T));
+            throw;
+        }
+        adopt(storage, new_cap);
+        ++count;
+        return *slot;
+    }
+
+    // Takes other's elements, leaving it empty. Heap storage changes hands
+    // when resources agree; inline elements are moved one by one.
+    void steal(small_vector& other) {
+        if (!other.is_inline() && *resource == *other.resource) {
+            release_storage();
+            first = std::exchange(other.first, other.inline_data());
+            count = std::exchange(other.count, 0);
+            cap = std::exchange(other.cap, N);
+            return;
+        }
+        reserve(other.count);
+        std::uninitialized_move(other.first, other.first + other.count, first);
+        count = other.count;
+        other.clear();
+    }
+
+    // Constructs elements [count, n) at `storage`; on a throw nothing is
+    // left constructed.
+    template<typename Construct>
+    void construct_tail(T* storage, size_t n, Construct& construct) {
+        size_t built = count;
+        try {
+            for (; built < n; ++built) {
+                construct(storage + built);
+            }
+        } catch (...) {
+            std::destroy(storage + count, storage + built);
+            throw;
+        }
+    }
+
+    // Like grow_and_emplace, the new elements are built in the new storage
+    // before the old ones move, so a throw leaves the vector (capacity
+    // included) as it was and `construct` may read existing elements.
+    template<typename Construct>
+    void resize_with(size_t n, Construct construct) {
+        if (n <= count) {
+            std::destroy(first + n, first + count);
+            count = n;
+            return;
+        }
+        if (n <= cap) {
+            construct_tail(first, n, construct);
+            count = n;
+            return;
+        }
+        if (n > max_size()) {
+            throw std::length_error("small_vector too long");
+        }
+        T* storage = allocate(n);
+        try {
+            construct_tail(storage, n, construct);
+            try {
+                relocate(first, count, storage);
+            } catch (...) {
+                std::destroy(storage + count, storage + n);
+                throw;
+            }
+        } catch (...) {
+            resource->deallocate(storage, n * sizeof(T), alignof(T));
+            throw;
+        }
+        adopt(storage, n);
+        count = n;
+    }
+
+public:
+    explicit small_vector(std::pmr::memory_resource* spill = std::pmr::get_default_resource())
+        : first(inline_data()), resource(spill) {}
+
+    small_vector(size_t n, const T& value, std::pmr::memory_resource* spill = std::pmr::get_default_resource())
+        : small_vector(spill) {
+        resize(n, value);
+    }
+
+    template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    small_vector(It begin_it, It end_it, std::pmr::memory_resource* spill = std::pmr::get_default_resource())
+        : small_vector(spill) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<It>::iterator_category>) {
+            size_t n = static_cast<size_t>(std::distance(begin_it, end_it));
+            reserve(n);
+            std::uninitialized_copy(begin_it, end_it, first);
+            count = n;
+        } else {
+            for (; begin_it != end_it; ++begin_it) {
+                emplace_back(*begin_it);
+            }
+        }
+    }
+
+    small_vector(std::initializer_list<T> values, std::pmr::memory_resource* spill = std::pmr::get_default_resource())
+        : small_vector(values.begin(), values.end(), spill) {}
+
+    small_vector(const small_vector& other) : small_vector(other.begin(), other.end()) {}
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : first(inline_data()), resource(other.resource) {
+        steal(other);
+    }
+
+    ~small_vector() {
+        std::destroy(first, first + count);
+        release_storage();
+    }
+
+    // The copy is built before anything is replaced and handed over in a
+    // way that can't throw, so a throw while copying leaves this vector as
+    // it was. A spilled copy gives up its heap storage; an inline one is
+    // moved in when moves are noexcept. Otherwise, since the old elements
+    // still occupy the inline storage, the copy is built in exactly-sized
+    // heap storage instead.
+    small_vector& operator=(const small_vector& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.count > N || std::is_nothrow_move_constructible_v<T>) {
+            small_vector copy(other.begin(), other.end(), resource);
+            clear();
+            steal(copy);
+            return *this;
+        }
+        if (other.count == 0) {
+            clear();
+            return *this;
+        }
+        T* storage = allocate(other.count);
+        try {
+            std::uninitialized_copy(other.begin(), other.end(), storage);
+        } catch (...) {
+            resource->deallocate(storage, other.count * sizeof(T), alignof(T));
+            throw;
+        }
+        adopt(storage, other.count);
+        count = other.count;
+        return *this;
+    }
+
+    // Basic guarantee only. Heap storage changes hands without touching
+    // the elements, but if other is inline (or its resource differs) they
+    // are moved one by one into this cleared vector. If a move throws,
+    // this vector is left empty and other's elements are valid but
+    // unspecified.
+    small_vector& operator=(small_vector&& other) {
+        if (this != &other) {
+            clear();
+            steal(other);
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<T> values) {
+        return *this = small_vector(values, resource);
+    }
+
+    // Element access
+    T& operator[](size_t i) { return first[i]; }
+    const T& operator[](size_t i) const { return first[i]; }
+
+    T& at(size_t i) {
+        if (i >= count) {
+            throw std::out_of_range("small_vector::at");
+        }
+        return first[i];
+    }
+
+    const T& at(size_t i) const { return const_cast<small_vector*>(this)->at(i); }
+
+    T& front() { return first[0]; }
+    const T& front() const { return first[0]; }
+    T& back() { return first[count - 1]; }
+    const T& back() const { return first[count - 1]; }
+    T* data() { return first; }
+    const T* data() const { return first; }
+
+    iterator begin() { return first; }
+    iterator end() { return first + count; }
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first + count; }
+
+    // Capacity
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+    static constexpr size_t inline_capacity() { return N; }
+    static constexpr size_t max_size() { return std::numeric_limits<size_t>::max() / sizeof(T); }
+    // False once the elements have spilled to the resource.
+    bool is_inline() const { return first == inline_data(); }
+    std::pmr::memory_resource* get_resource() const { return resource; }
+
+    void reserve(size_t n) {
+        if (n <= cap) {
+            return;
+        }
+        if (n > max_size()) {
+            throw std::length_error("small_vector too long");
+        }
+        T* storage = allocate(n);
+        try {
+            relocate(first, count, storage);
+        } catch (...) {
+            resource->deallocate(storage, n * sizeof(T), alignof(T));
+            throw;
+        }
+        adopt(storage, n);
+    }
+
+    // Moves the elements back inline if they fit, else into exactly-sized
+    // storage. Best effort: a failed move leaves the vector as it was.
+    void shrink_to_fit() {
+        if (is_inline() || count == cap) {
+            return;
+        }
+        if (count <= N) {
+            T* storage = inline_data();
+            relocate(first, count, storage);
+            std::destroy(first, first + count);
+            resource->deallocate(first, cap * sizeof(T), alignof(T));
+            first = storage;
+            cap = N;
+            return;
+        }
+        T* storage = allocate(count);
+        try {
+            relocate(first, count, storage);
+        } catch (...) {
+            resource->deallocate(storage, count * sizeof(T), alignof(T));
+            throw;
+        }
+        adopt(storage, count);
+    }
+
+    // Modifiers
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (count == cap) {
+            return grow_and_emplace(std::forward<Args>(args)...);
+        }
+        T* slot = ::new (static_cast<void*>(first + count)) T(std::forward<Args>(args)...);
+        ++count;
+        return *slot;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --count;
+        first[count].~T();
+    }
+
+    void clear() {
+        std::destroy(first, first + count);
+        count = 0;
+    }
+
+    // New elements are value-initialized (resize(n)) or copies of value.
+    // If constructing one throws, the size is unchanged.
+    void resize(size_t n) { resize_with(n, [](T* slot) { ::new (static_cast<void*>(slot)) T(); }); }
+    void resize(size_t n, const T& value) {
+        resize_with(n, [&value](T* slot) { ::new (static_cast<void*>(slot)) T(value); });
+    }
+
+    iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+    iterator erase(const_iterator begin_it, const_iterator end_it) {
+        T* target = first + (begin_it - first);
+        T* tail = first + (end_it - first);
+        if (target != tail) {
+            T* new_end = std::move(tail, first + count, target);
+            std::destroy(new_end, first + count);
+            count = static_cast<size_t>(new_end - first);
+        }
+        return target;
+    }
+
+    void swap(small_vector& other) {
+        if (this == &other) {
+            return;
+        }
+        small_vector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    friend void swap(small_vector& a, small_vector& b) { a.swap(b); }
+
+    friend bool operator==(const small_vector& a, const small_vector& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend bool operator!=(const small_vector& a, const small_vector& b) { return !(a == b); }
+
+};
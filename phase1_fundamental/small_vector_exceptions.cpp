@@ -0,0 +1,206 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "small_vector.h"
+
+// Exception-safety checks for small_vector. Every constructor of Element
+// counts down a shared budget and throws when it runs out; each operation
+// is retried with budgets 0, 1, 2, ... until it gets through, so a throw
+// is injected at every construction it makes in turn. After each throw:
+//
+// - push_back, emplace_back, reserve, resize and copy assignment must
+//   leave the vector exactly as it was (the strong guarantee);
+// - move assignment must leave both vectors destructible with no element
+//   leaked or destroyed twice (the basic guarantee).
+//
+// Vectors start below, at and above the inline capacity, so the inline,
+// spilling and heap paths all throw. Element comes with a noexcept move
+// (elements relocate by moving) and a throwing one (they relocate by
+// copying). Run under ASan by test_small_vector.sh.
+
+static long live = 0;           // Elements constructed and not destroyed
+static long budget = -1;        // constructions left before one throws; -1 = no limit
+
+static void construct_or_throw() {
+    if (budget == 0) {
+        throw std::runtime_error("injected");
+    }
+    if (budget > 0) {
+        --budget;
+    }
+}
+
+template<bool NothrowMove>
+struct Element {
+    int value;
+
+    Element(int v = -1) : value(v) {
+        construct_or_throw();
+        ++live;
+    }
+
+    Element(const Element& other) : value(other.value) {
+        construct_or_throw();
+        ++live;
+    }
+
+    Element(Element&& other) noexcept(NothrowMove) : value(other.value) {
+        if (!NothrowMove) {
+            construct_or_throw();
+        }
+        ++live;
+    }
+
+    Element& operator=(const Element& other) = default;
+    Element& operator=(Element&& other) = default;
+
+    ~Element() { --live; }
+};
+
+static constexpr size_t N = 4;
+static const size_t SIZES[] = {2, N, N + 2};    // below, at and above inline capacity
+
+static int failures = 0;
+static int checks = 0;
+
+template<typename Vector>
+static Vector make(size_t n, int base = 0) {
+    Vector v;
+    for (size_t i = 0; i < n; ++i) {
+        v.emplace_back(base + static_cast<int>(i));
+    }
+    return v;
+}
+
+template<typename Vector>
+static std::vector<int> values(const Vector& v) {
+    std::vector<int> out;
+    for (const auto& element : v) {
+        out.push_back(element.value);
+    }
+    return out;
+}
+
+static void fail(const std::string& what) {
+    if (failures++ < 10) {
+        std::cout << "FAILED: " << what << "\n";
+    }
+}
+
+// Retries op(v) with growing budgets. After every injected throw v must
+// hold what it held before and no Element may have leaked.
+template<typename Vector, typename Op>
+static void check_strong(const std::string& label, size_t size, Op op) {
+    for (long attempt = 0;; ++attempt) {
+        Vector v = make<Vector>(size);
+        std::vector<int> before = values(v);
+        size_t capacity = v.capacity();
+        long others = live - static_cast<long>(v.size());
+        budget = attempt;
+        bool threw = false;
+        try {
+            op(v);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        budget = -1;
+        std::string where = label + " (size " + std::to_string(size) + ", throw at construction "
+                            + std::to_string(attempt) + ")";
+        if (live != others + static_cast<long>(v.size())) {
+            fail(where + ": " + std::to_string(live - others) + " live elements for size "
+                 + std::to_string(v.size()));
+        }
+        if (!threw) {
+            ++checks;
+            return;
+        }
+        if (values(v) != before || v.capacity() != capacity) {
+            fail(where + ": vector changed");
+        }
+        if (attempt > 100) {
+            fail(where + ": never succeeded");
+            return;
+        }
+    }
+}
+
+template<bool NothrowMove>
+static void run_all(const char* type_name) {
+    using E = Element<NothrowMove>;
+    using Vector = small_vector<E, N>;
+    const std::string suffix = std::string(" [") + type_name + "]";
+    const E extra(99);
+
+    for (size_t size : SIZES) {
+        check_strong<Vector>("push_back copy" + suffix, size, [&](Vector& v) { v.push_back(extra); });
+        check_strong<Vector>("push_back temporary" + suffix, size, [](Vector& v) { v.push_back(E(7)); });
+        check_strong<Vector>("emplace_back" + suffix, size, [](Vector& v) { v.emplace_back(7); });
+        check_strong<Vector>("reserve" + suffix, size, [size](Vector& v) { v.reserve(size + 5); });
+        check_strong<Vector>("resize" + suffix, size, [size](Vector& v) { v.resize(size + 3); });
+        check_strong<Vector>("resize with value" + suffix, size,
+                             [&, size](Vector& v) { v.resize(size + 3, extra); });
+        check_strong<Vector>("resize with own element" + suffix, size,
+                             [size](Vector& v) { v.resize(size + 3, v[0]); });
+
+        for (size_t source_size : SIZES) {
+            const Vector source = make<Vector>(source_size, 100);
+            check_strong<Vector>("copy assign from size " + std::to_string(source_size) + suffix, size,
+                                 [&](Vector& v) {
+                                     v = source;
+                                     if (values(v) != values(source)) {
+                                         fail("copy assign: wrong contents");
+                                     }
+                                 });
+        }
+    }
+
+    // Move assignment: only the basic guarantee.
+    for (size_t size : SIZES) {
+        for (size_t source_size : SIZES) {
+            for (long attempt = 0;; ++attempt) {
+                Vector v = make<Vector>(size);
+                Vector source = make<Vector>(source_size, 100);
+                long others = live - static_cast<long>(v.size() + source.size());
+                budget = attempt;
+                bool threw = false;
+                try {
+                    v = std::move(source);
+                } catch (const std::runtime_error&) {
+                    threw = true;
+                }
+                budget = -1;
+                if (live != others + static_cast<long>(v.size() + source.size())) {
+                    fail("move assign" + suffix + ": elements leaked or lost");
+                }
+                if (!threw) {
+                    if (v.size() != source_size || values(v) != values(make<Vector>(source_size, 100))) {
+                        fail("move assign" + suffix + ": wrong contents");
+                    }
+                    ++checks;
+                    break;
+                }
+                if (attempt > 100) {
+                    fail("move assign" + suffix + ": never succeeded");
+                    break;
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    run_all<true>("noexcept move");
+    run_all<false>("throwing move");
+    if (live != 0) {
+        fail(std::to_string(live) + " elements still live at exit");
+    }
+    if (failures) {
+        std::cout << failures << " failure(s)\n";
+        return 1;
+    }
+    std::cout << checks << " operations survived a throw at every construction\n";
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "soa_vector.h"
+
+// Array-of-structs vs structure-of-arrays for EnhancedMemoryDemo's data:
+// two ints and a 100-byte array per object (108 bytes).
+//
+// "scan member1" sums one int per object. Laid out as structs, each
+// element drags its whole 108 bytes through the cache (the hardware
+// prefetcher streams the lines between the ints too); in a soa_vector
+// the ints are packed and 4 bytes per element is all that moves.
+// "update all" writes every field, so both layouts touch every byte.
+class SoaBenchmark {
+public:
+    // Same members, same layout as EnhancedMemoryDemo.
+    struct DemoObject {
+        int member1;
+        int member2;
+        char member_array[100];
+    };
+
+    using DemoColumns = soa_vector<int, int, std::array<char, 100>>;
+
+    struct Row {
+        std::string name;
+        double ns_per_element;
+        size_t bytes_per_element;
+    };
+
+    static std::vector<Row> rows;
+
+    static void fill(std::vector<DemoObject>& objects, DemoColumns& columns, size_t count) {
+        objects.resize(count);
+        columns.reserve(count);
+        std::array<char, 100> text;
+        for (int i = 0; i < 100; i++) {
+            text[i] = 'A' + (i % 26);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            DemoObject& object = objects[i];
+            object.member1 = static_cast<int>(i);
+            object.member2 = static_cast<int>(i * 2);
+            std::copy(text.begin(), text.end(), object.member_array);
+            columns.emplace_back(static_cast<int>(i), static_cast<int>(i * 2), text);
+        }
+    }
+
+    static long long scanObjects(const std::vector<DemoObject>& objects) {
+        long long sum = 0;
+        for (const DemoObject& object : objects) {
+            sum += object.member1;
+        }
+        return sum;
+    }
+
+    static long long scanColumn(const DemoColumns& columns) {
+        long long sum = 0;
+        for (int member1 : columns.column<0>()) {
+            sum += member1;
+        }
+        return sum;
+    }
+
+    static void updateObjects(std::vector<DemoObject>& objects) {
+        for (DemoObject& object : objects) {
+            object.member1 += object.member2;
+            object.member2 ^= 1;
+            for (char& c : object.member_array) {
+                c ^= 1;
+            }
+        }
+    }
+
+    // The same loop, through the element proxies.
+    static void updateColumns(DemoColumns& columns) {
+        for (auto [member1, member2, member_array] : columns) {
+            member1 += member2;
+            member2 ^= 1;
+            for (char& c : member_array) {
+                c ^= 1;
+            }
+        }
+    }
+
+    static void record(const std::string& name, const bench::Result& result, size_t bytes) {
+        rows.push_back(Row{name, result.median, bytes});
+    }
+};
+
+std::vector<SoaBenchmark::Row> SoaBenchmark::rows;
+
+int main(int argc, char** argv) {
+    size_t count = 4000000;
+    if (argc > 1 && argv[1][0] != '-') {
+        count = std::strtoul(argv[1], nullptr, 10);
+    }
+    bench::Options options;
+    options.warmup_samples = 1;
+    options.samples = 5;
+    bench::Suite suite("soa_benchmark", argc, argv, options);
+
+    std::vector<SoaBenchmark::DemoObject> objects;
+    SoaBenchmark::DemoColumns columns;
+    SoaBenchmark::fill(objects, columns, count);
+    const size_t object_bytes = sizeof(SoaBenchmark::DemoObject);
+    const size_t all_field_bytes = sizeof(int) + sizeof(int) + 100;
+
+    auto aos_scan = suite.run("AoS scan member1", [&] {
+        bench::DoNotOptimize(SoaBenchmark::scanObjects(objects));
+    }, count);
+    SoaBenchmark::record("AoS scan member1", aos_scan, object_bytes);
+
+    auto soa_scan = suite.run("SoA scan member1", [&] {
+        bench::DoNotOptimize(SoaBenchmark::scanColumn(columns));
+    }, count);
+    SoaBenchmark::record("SoA scan member1", soa_scan, sizeof(int));
+
+    auto aos_update = suite.run("AoS update all", [&] { SoaBenchmark::updateObjects(objects); }, count);
+    SoaBenchmark::record("AoS update all", aos_update, object_bytes);
+
+    auto soa_update = suite.run("SoA update all", [&] { SoaBenchmark::updateColumns(columns); }, count);
+    SoaBenchmark::record("SoA update all", soa_update, all_field_bytes);
+
+    bool same = SoaBenchmark::scanObjects(objects) == SoaBenchmark::scanColumn(columns);
+    std::printf("\n%zu elements (%zu MiB as structs)%s\n", count, count * object_bytes >> 20,
+                same ? "" : "  (MISMATCH)");
+    std::printf("%-20s %10s %12s %10s\n", "", "ns/elem", "bytes/elem", "GB/s");
+    for (const auto& row : SoaBenchmark::rows) {
+        std::printf("%-20s %10.2f %12zu %10.2f\n", row.name.c_str(), row.ns_per_element, row.bytes_per_element,
+                    row.bytes_per_element / row.ns_per_element);
+    }
+    std::printf("scan: SoA %.1fx faster; update: SoA %.2fx\n", aos_scan.median / soa_scan.median,
+                aos_update.median / soa_update.median);
+    return 0;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits.h>
+#include <optional>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <system_error>
+#include <type_traits>
+#include <ucontext.h>
+#include <unistd.h>
+#include <utility>
+
+// Runs a callable on a stack of a chosen size and reports how much of it
+// the call used.
+//
+// The stack is an mmap region with PROT_NONE guard pages below it, so
+// running off the end is an immediate SIGSEGV rather than a silent write
+// into whatever is mapped next. It is painted with a byte pattern when
+// created; after each run the executor scans up from the bottom for the
+// first overwritten word, which gives the call's deepest point (the
+// high-water mark) to the word, then repaints just the part that was used.
+// Painting commits the whole stack once, so size it for the job.
+//
+// Method::Thread runs the call on a new thread given the stack with
+// pthread_attr_setstack; glibc keeps that thread's TLS and descriptor at
+// the top of the stack, which shows up in the usage (a few KiB).
+// Method::Context switches to the stack on the calling thread with
+// swapcontext: no thread, but sanitizers that track the stack (ASan,
+// TSan) don't follow the switch. Exceptions thrown by the call are
+// rethrown to the caller either way.
+class StackExecutor {
+public:
+    enum class Method { Thread, Context };
+
+    struct Usage {
+        size_t size = 0;        // usable bytes, excluding the guard
+        size_t used = 0;        // high-water mark of the last run
+        size_t guard = 0;
+
+        size_t remaining() const { return size - used; }
+    };
+
+    static constexpr unsigned char PAINT = 0xcd;
+
+private:
+    static constexpr uint64_t PAINT_WORD = 0xcdcdcdcdcdcdcdcdull;
+
+    struct Task {
+        void (*call)(void*);
+        void* argument;
+        char* low;              // bottom of the usable stack
+        ucontext_t caller;
+        ucontext_t callee;
+    };
+
+    char* mapping = nullptr;
+    size_t mapping_bytes = 0;
+    char* low = nullptr;
+    char* high = nullptr;
+    size_t guard_bytes = 0;
+    Method method;
+    Usage last;
+
+    static size_t page_size() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+
+    // Bottom of the stack the current thread is running on, for remaining().
+    static char*& current_low() {
+        static thread_local char* bottom = nullptr;
+        return bottom;
+    }
+
+    static void* thread_start(void* argument) {
+        Task* task = static_cast<Task*>(argument);
+        current_low() = task->low;
+        task->call(task->argument);
+        return nullptr;
+    }
+
+    // makecontext passes int arguments only, so the pointer goes in halves.
+    static void context_start(unsigned high_half, unsigned low_half) {
+        Task* task = reinterpret_cast<Task*>(static_cast<uintptr_t>(high_half) << 32 | low_half);
+        task->call(task->argument);
+    }
+
+    void execute(void (*call)(void*), void* argument) {
+        Task task{call, argument, low, {}, {}};
+        if (method == Method::Thread) {
+            pthread_attr_t attr;
+            pthread_attr_init(&attr);
+            int error = pthread_attr_setstack(&attr, low, static_cast<size_t>(high - low));
+            pthread_t thread;
+            if (error == 0) {
+                error = pthread_create(&thread, &attr, thread_start, &task);
+            }
+            pthread_attr_destroy(&attr);
+            if (error != 0) {
+                throw std::system_error(error, std::generic_category(), "StackExecutor thread");
+            }
+            pthread_join(thread, nullptr);
+            return;
+        }
+        if (getcontext(&task.callee) != 0) {
+            throw std::system_error(errno, std::generic_category(), "getcontext");
+        }
+        task.callee.uc_stack.ss_sp = low;
+        task.callee.uc_stack.ss_size = static_cast<size_t>(high - low);
+        task.callee.uc_link = &task.caller;
+        uintptr_t bits = reinterpret_cast<uintptr_t>(&task);
+        makecontext(&task.callee, reinterpret_cast<void (*)()>(context_start), 2,
+                    static_cast<unsigned>(bits >> 32), static_cast<unsigned>(bits));
+        char* outer_low = std::exchange(current_low(), low);
+        swapcontext(&task.caller, &task.callee);
+        current_low() = outer_low;
+    }
+
+    // Finds the deepest overwritten word, records the usage and repaints
+    // what the run touched.
+    void measure() {
+        const uint64_t* word = reinterpret_cast<const uint64_t*>(low);
+        const uint64_t* top = reinterpret_cast<const uint64_t*>(high);
+        while (word < top && *word == PAINT_WORD) {
+            ++word;
+        }
+        char* deepest = const_cast<char*>(reinterpret_cast<const char*>(word));
+        last.used = static_cast<size_t>(high - deepest);
+        std::memset(deepest, PAINT, last.used);
+    }
+
+public:
+    // `stack_bytes` is rounded up to whole pages (and to PTHREAD_STACK_MIN);
+    // `guard_pages` PROT_NONE pages go below it.
+    explicit StackExecutor(size_t stack_bytes, Method run_method = Method::Thread, size_t guard_pages = 1)
+        : method(run_method) {
+        size_t page = page_size();
+        size_t usable = std::max<size_t>(stack_bytes, PTHREAD_STACK_MIN);
+        usable = (usable + page - 1) / page * page;
+        guard_bytes = guard_pages * page;
+        mapping_bytes = guard_bytes + usable;
+        void* mapped = mmap(nullptr, mapping_bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap stack");
+        }
+        mapping = static_cast<char*>(mapped);
+        if (guard_bytes && mprotect(mapping, guard_bytes, PROT_NONE) != 0) {
+            int saved = errno;
+            munmap(mapping, mapping_bytes);
+            throw std::system_error(saved, std::generic_category(), "mprotect guard");
+        }
+        low = mapping + guard_bytes;
+        high = low + usable;
+        std::memset(low, PAINT, usable);
+        last.size = usable;
+        last.guard = guard_bytes;
+    }
+
+    ~StackExecutor() {
+        if (mapping) {
+            munmap(mapping, mapping_bytes);
+        }
+    }
+
+    StackExecutor(const StackExecutor&) = delete;
+    StackExecutor& operator=(const StackExecutor&) = delete;
+
+    // Runs f() on the stack and returns its result. One run at a time.
+    template<typename F>
+    std::invoke_result_t<F&> run(F&& f) {
+        using Result = std::invoke_result_t<F&>;
+        static_assert(!std::is_reference_v<Result>, "StackExecutor::run can't return a reference");
+        std::exception_ptr error;
+        if constexpr (std::is_void_v<Result>) {
+            auto body = [&] {
+                try {
+                    f();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            };
+            execute([](void* p) { (*static_cast<decltype(body)*>(p))(); }, &body);
+            measure();
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        } else {
+            std::optional<Result> result;
+            auto body = [&] {
+                try {
+                    result.emplace(f());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            };
+            execute([](void* p) { (*static_cast<decltype(body)*>(p))(); }, &body);
+            measure();
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return std::move(*result);
+        }
+    }
+
+    // Stack size, guard and the high-water mark of the last run.
+    const Usage& usage() const { return last; }
+
+    // Bytes left between here and the bottom of the current thread's stack
+    // (the executor's stack inside run(), the thread's own stack
+    // elsewhere). 0 if it can't be determined.
+    static size_t remaining() {
+        char here;
+        char*& bottom = current_low();
+        if (!bottom) {
+            pthread_attr_t attr;
+            void* address = nullptr;
+            size_t size = 0;
+            if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+                pthread_attr_getstack(&attr, &address, &size);
+                pthread_attr_destroy(&attr);
+            }
+            bottom = static_cast<char*>(address);
+        }
+        return bottom && &here > bottom ? static_cast<size_t>(&here - bottom) : 0;
+    }
+};
@@ -0,0 +1,67 @@
+#!/bin/bash
+
+echo "=== Lock-Free List Stress Tests ==="
+echo "Readers traverse while writers unlink; reclamation must stay sanitizer-clean"
+echo ""
+
+SOURCE_FILE="lockfree_list_stress.cpp"
+
+if [ ! -f "$SOURCE_FILE" ]; then
+    echo "Error: $SOURCE_FILE not found!"
+    exit 1
+fi
+
+failures=0
+
+# check LABEL BINARY ARGS...: the run must exit 0 with no sanitizer report
+check() {
+    label="$1"
+    shift
+    output=$("$@" 2>&1)
+    status=$?
+    if [ $status -eq 0 ] && ! echo "$output" | grep -q "Sanitizer"; then
+        echo "  ✓ $label: $(echo "$output" | tail -1)"
+    else
+        echo "  ✗ $label failed (exit $status)"
+        echo "$output" | grep -m5 "ERROR\|WARNING\|FAILED\|mismatch" | sed 's/^/      /'
+        failures=$((failures + 1))
+    fi
+}
+
+echo "1. ThreadSanitizer..."
+if g++ -std=c++17 -g -O1 -fsanitize=thread -pthread "$SOURCE_FILE" -o lockfree_list_tsan; then
+    check "4 readers / 4 writers" ./lockfree_list_tsan 4 4 20000
+    check "1 reader / 8 writers" ./lockfree_list_tsan 1 8 10000
+else
+    echo "✗ Compilation failed with TSan"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "2. AddressSanitizer + UBSan (use after reclaim, leaks)..."
+if g++ -std=c++17 -g -O1 -fsanitize=address,undefined -pthread "$SOURCE_FILE" -o lockfree_list_asan; then
+    check "4 readers / 4 writers" ./lockfree_list_asan 4 4 50000
+    check "8 readers / 2 writers" ./lockfree_list_asan 8 2 50000
+else
+    echo "✗ Compilation failed with ASan"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "3. Release build..."
+if g++ -std=c++17 -O2 -pthread "$SOURCE_FILE" -o lockfree_list_release; then
+    check "4 readers / 4 writers" ./lockfree_list_release 4 4 200000
+else
+    echo "✗ Release compilation failed"
+    failures=$((failures + 1))
+fi
+echo ""
+
+rm -f lockfree_list_tsan lockfree_list_asan lockfree_list_release
+
+if [ $failures -eq 0 ]; then
+    echo "=== All lock-free list checks passed ==="
+else
+    echo "=== $failures lock-free list check(s) failed ==="
+    exit 1
+fi
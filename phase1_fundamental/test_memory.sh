@@ -15,21 +15,47 @@ fi
 echo "Testing file: $SOURCE_FILE"
 echo ""
 
+# Every variant compiles at once (the compiles are most of the wall time),
+# then each one runs its cases in parallel, one process per case (see
+# test_runner.h). Per-case results go to memory_tests.<variant>.json.
+echo "Building all variants in parallel..."
+build() {
+    output=$1
+    shift
+    g++ -std=c++17 "$@" "$SOURCE_FILE" -o "$output" > "$output.log" 2>&1
+}
+build memory_tests_asan -fsanitize=address -fsanitize=leak -g -O1 &
+build memory_tests_valgrind -g -O1 &
+build memory_tests_basic -g -Wall -Wextra -Wpedantic -Wconversion -Wshadow &
+build memory_tests_tracked -g -O2 -rdynamic -DMEMORY_TRACKER &
+build memory_tests_profiled -g -O2 -rdynamic -DHEAP_PROFILER &
+build memory_tests_telemetry -g -O2 -DMEMORY_TELEMETRY -pthread &
+wait
+echo ""
+
+failed_variants=""
+# check NAME STATUS: remember variants whose run had failing cases
+check() {
+    if [ "$2" -ne 0 ]; then
+        failed_variants="$failed_variants $1"
+    fi
+}
+
 # Method 1: AddressSanitizer (ASan) - Fast, integrated with compiler
 echo "1. Testing with AddressSanitizer (ASan)..."
 echo "   - Pros: Fast, catches many errors immediately, good for development"
 echo "   - Cons: Some overhead, may miss certain types of errors"
 echo ""
 
-g++ -std=c++17 -fsanitize=address -fsanitize=leak -g -O1 "$SOURCE_FILE" -o memory_tests_asan
-
-if [ $? -eq 0 ]; then
+if [ -x memory_tests_asan ]; then
     echo "✓ Compiled successfully with AddressSanitizer"
-    echo "Running with ASan..."
-    ./memory_tests_asan
+    echo "Running with ASan (LeakSanitizer checks each case's process)..."
+    ./memory_tests_asan --json=memory_tests.asan.json
+    check asan $?
     echo ""
 else
     echo "✗ Compilation failed with AddressSanitizer"
+    cat memory_tests_asan.log
     echo ""
 fi
 
@@ -39,48 +65,129 @@ echo "   - Pros: Very comprehensive, catches subtle errors, no recompilation nee
 echo "   - Cons: Slower execution, requires separate installation"
 echo ""
 
-# Compile without sanitizers for Valgrind
-g++ -std=c++17 -g -O1 "$SOURCE_FILE" -o memory_tests_valgrind
-
-if [ $? -eq 0 ]; then
+# Built without sanitizers for Valgrind
+if [ -x memory_tests_valgrind ]; then
     echo "✓ Compiled successfully for Valgrind"
     echo "Running with Valgrind..."
     
-    # Check if valgrind is installed
+    # Check if valgrind is installed. It follows the forked cases, so each
+    # case gets its own leak summary
     if command -v valgrind &> /dev/null; then
-        valgrind --leak-check=full --show-leak-kinds=all --track-origins=yes --verbose ./memory_tests_valgrind
+        valgrind --leak-check=full --show-leak-kinds=all --track-origins=yes --verbose \
+            ./memory_tests_valgrind --json=memory_tests.valgrind.json
     else
         echo "Valgrind not found. Install with: sudo apt-get install valgrind"
         echo "Running without Valgrind:"
-        ./memory_tests_valgrind
+        ./memory_tests_valgrind --json=memory_tests.valgrind.json
     fi
+    check valgrind $?
     echo ""
 else
     echo "✗ Compilation failed for Valgrind"
+    cat memory_tests_valgrind.log
     echo ""
 fi
 
 # Method 3: Basic compilation with warnings
 echo "3. Basic compilation with enhanced warnings..."
-g++ -std=c++17 -g -Wall -Wextra -Wpedantic -Wconversion -Wshadow "$SOURCE_FILE" -o memory_tests_basic
+cat memory_tests_basic.log
 
-if [ $? -eq 0 ]; then
+if [ -x memory_tests_basic ]; then
     echo "✓ Compiled successfully with warnings"
     echo "Running basic version..."
-    ./memory_tests_basic
+    ./memory_tests_basic --json=memory_tests.basic.json
+    check basic $?
     echo ""
 else
     echo "✗ Compilation failed"
     echo ""
 fi
 
+# Method 4: In-process allocation tracker - near-native speed, fails on net leaks
+echo "4. Testing with the in-process allocation tracker..."
+echo "   - Pros: A few percent overhead, cheap enough for every CI job"
+echo "   - Cons: Only sees operator new/delete, no invalid-access checks"
+echo ""
+
+if [ -x memory_tests_tracked ]; then
+    echo "✓ Compiled successfully with MEMORY_TRACKER"
+    echo "Running tracked version..."
+    ./memory_tests_tracked --json=memory_tests.tracked.json
+    check tracked $?
+    echo ""
+else
+    echo "✗ Compilation failed with MEMORY_TRACKER"
+    cat memory_tests_tracked.log
+    echo ""
+fi
+
+# Method 5: Sampling heap profiler - collapsed stacks for flamegraph.pl
+echo "5. Profiling with the sampling heap profiler..."
+echo "   - Pros: Shows which stacks allocate, cheap at the default sampling rate"
+echo "   - Cons: Statistical; small programs need a low HEAP_PROFILE_RATE to get samples"
+echo ""
+
+if [ -x memory_tests_profiled ]; then
+    echo "✓ Compiled successfully with HEAP_PROFILER"
+    echo "Running profiled version in one process (one sample per 4 KiB)..."
+    HEAP_PROFILE_RATE=4096 ./memory_tests_profiled --no-fork --json=memory_tests.profiled.json
+    check profiled $?
+    if command -v flamegraph.pl &> /dev/null; then
+        flamegraph.pl heap_profile.alloc.collapsed > heap_profile.alloc.svg
+        echo "Wrote heap_profile.alloc.svg"
+    else
+        echo "flamegraph.pl not found; heap_profile.*.collapsed kept for later"
+    fi
+    echo ""
+else
+    echo "✗ Compilation failed with HEAP_PROFILER"
+    cat memory_tests_profiled.log
+    echo ""
+fi
+
+# Method 6: Memory telemetry - RSS, page faults and heap over time
+echo "6. Recording a memory timeline with the telemetry sampler..."
+echo "   - Pros: Shows what the process costs the OS (RSS, faults), per test case"
+echo "   - Cons: Whole-process view; says nothing about which allocation grew"
+echo ""
+
+if [ -x memory_tests_telemetry ]; then
+    echo "✓ Compiled successfully with MEMORY_TELEMETRY"
+    echo "Running in one process with a 1 ms sampling interval..."
+    MEMORY_TELEMETRY=memory_tests.telemetry.csv MEMORY_TELEMETRY_INTERVAL_MS=1 \
+        ./memory_tests_telemetry --no-fork --json=memory_tests.telemetry.json
+    check telemetry $?
+    echo "Timeline (time_ms, label, rss_kb, minor_faults) in memory_tests.telemetry.csv:"
+    grep -E 'begin|end' memory_tests.telemetry.csv | cut -d, -f1,2,4,8
+    echo ""
+else
+    echo "✗ Compilation failed with MEMORY_TELEMETRY"
+    cat memory_tests_telemetry.log
+    echo ""
+fi
+
 # Cleanup
 echo "Cleaning up compiled files..."
-rm -f memory_tests_asan memory_tests_valgrind memory_tests_basic
+for variant in asan valgrind basic tracked profiled telemetry; do
+    rm -f "memory_tests_$variant" "memory_tests_$variant.log"
+done
 
 echo "=== Testing Complete ==="
+if [ -n "$failed_variants" ]; then
+    echo "✗ Failing cases in:$failed_variants (see memory_tests.<variant>.json)"
+else
+    echo "✓ Every variant passed all cases (per-case results in memory_tests.*.json)"
+fi
 echo ""
 echo "SUMMARY:"
 echo "- Use AddressSanitizer during development for quick feedback"
 echo "- Use Valgrind for thorough final testing"
+echo "- Use the allocation tracker (-DMEMORY_TRACKER) for fast leak checks everywhere"
+echo "- Use the heap profiler (-DHEAP_PROFILER) to see which stacks allocate"
+echo "- Use memory telemetry (-DMEMORY_TELEMETRY) to see RSS and page faults over time"
 echo "- Always compile with warnings enabled"
+echo "- Pass --no-fork, --jobs=N or --filter=NAME to the test binary to change how cases run"
+
+if [ -n "$failed_variants" ]; then
+    exit 1
+fi
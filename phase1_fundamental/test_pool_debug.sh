@@ -0,0 +1,82 @@
+#!/bin/bash
+
+echo "=== SimplePool Debug Mode Tests ==="
+echo "Every misuse case in pool_debug_practice.cpp must be caught"
+echo ""
+
+SOURCE_FILE="pool_debug_practice.cpp"
+
+if [ ! -f "$SOURCE_FILE" ]; then
+    echo "Error: $SOURCE_FILE not found!"
+    exit 1
+fi
+
+failures=0
+
+# expect BINARY CASE PATTERN: the case must exit non-zero and print PATTERN
+expect() {
+    output=$(./"$1" "$2" 2>&1)
+    status=$?
+    if [ $status -ne 0 ] && echo "$output" | grep -q "$3"; then
+        echo "  ✓ $2 caught ($3)"
+    else
+        echo "  ✗ $2 NOT caught (exit $status)"
+        echo "$output" | head -5 | sed 's/^/      /'
+        failures=$((failures + 1))
+    fi
+}
+
+expect_ok() {
+    if ./"$1" ok > /dev/null 2>&1; then
+        echo "  ✓ correct usage runs clean"
+    else
+        echo "  ✗ correct usage failed"
+        failures=$((failures + 1))
+    fi
+}
+
+echo "1. POOL_DEBUG + AddressSanitizer..."
+if g++ -std=c++17 -g -O1 -fsanitize=address -DPOOL_DEBUG "$SOURCE_FILE" -o pool_debug_asan; then
+    expect_ok pool_debug_asan
+    expect pool_debug_asan use-after-free "use-after-poison"
+    expect pool_debug_asan write-after-free "use-after-poison"
+    expect pool_debug_asan double-free "double free"
+    expect pool_debug_asan foreign-pointer "not allocated from this pool"
+    expect pool_debug_asan interior-pointer "middle of a block"
+    expect pool_debug_asan overflow "use-after-poison"
+else
+    echo "✗ Compilation failed with POOL_DEBUG + ASan"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "2. POOL_DEBUG without sanitizers (fill pattern and bookkeeping only)..."
+if g++ -std=c++17 -g -O1 -DPOOL_DEBUG "$SOURCE_FILE" -o pool_debug_plain; then
+    expect_ok pool_debug_plain
+    expect pool_debug_plain write-after-free "use after free"
+    expect pool_debug_plain double-free "double free"
+    expect pool_debug_plain foreign-pointer "not allocated from this pool"
+    expect pool_debug_plain interior-pointer "middle of a block"
+else
+    echo "✗ Compilation failed with POOL_DEBUG"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "3. Release build (checks compiled out)..."
+if g++ -std=c++17 -O2 "$SOURCE_FILE" -o pool_debug_release; then
+    expect_ok pool_debug_release
+else
+    echo "✗ Release compilation failed"
+    failures=$((failures + 1))
+fi
+echo ""
+
+rm -f pool_debug_asan pool_debug_plain pool_debug_release
+
+if [ $failures -eq 0 ]; then
+    echo "=== All pool debug checks passed ==="
+else
+    echo "=== $failures pool debug check(s) failed ==="
+    exit 1
+fi
@@ -0,0 +1,448 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __SANITIZE_ADDRESS__
+#include <sanitizer/lsan_interface.h>
+#endif
+
+#include "output_sink.h"
+
+// Runs registered test cases and reports each one's status, wall time and
+// peak RSS, optionally as JSON (--json=FILE).
+//
+// By default every case runs in its own forked child, up to one child per
+// CPU at a time (--jobs=N). A case that throws, aborts, segfaults or runs
+// past the timeout (--timeout=SECONDS, 60 by default) fails on its own and
+// the rest still run. Each child's stdout and stderr go through a pipe and
+// are printed in one piece when the case finishes, so parallel cases don't
+// interleave. Peak RSS comes from wait4(); it includes whatever the parent
+// had mapped at fork. Built with ASan, a child also runs LeakSanitizer
+// before exiting, so a leak fails the case that made it.
+//
+// --no-fork runs the cases one at a time in this process, which is what
+// tools that collect at exit (heap profiler, telemetry timeline) need; an
+// exception still fails only its own case, but a crash ends the run, and
+// peak RSS is the process high-water mark so far. --filter=TEXT runs only
+// cases whose name contains TEXT.
+//
+// A child leaves with _exit(), so static destructors and atexit handlers
+// don't run there; the standard OutputSink, std::cout and stdio are
+// flushed first.
+namespace test_runner {
+
+enum class Status { Passed, Failed, Crashed, TimedOut };
+
+inline const char* status_name(Status status) {
+    switch (status) {
+    case Status::Passed:
+        return "passed";
+    case Status::Failed:
+        return "failed";
+    case Status::Crashed:
+        return "crashed";
+    case Status::TimedOut:
+        return "timed_out";
+    }
+    return "unknown";
+}
+
+struct Options {
+    unsigned jobs = 0;              // cases at once; 0 = one per CPU
+    bool isolate = true;            // fork a child per case
+    double timeout_seconds = 60;    // forked cases only; 0 = no limit
+};
+
+struct Result {
+    std::string name;
+    Status status = Status::Passed;
+    std::string message;            // exception text, signal or exit code
+    std::string output;             // what a forked case wrote
+    double wall_ms = 0;
+    long peak_rss_kb = 0;
+
+    bool passed() const { return status == Status::Passed; }
+};
+
+class Runner {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Case {
+        std::string name;
+        std::function<void()> body;
+    };
+
+    struct Child {
+        size_t slot;                // index into results and the message area
+        pid_t pid;
+        int fd;                     // read end of the output pipe
+        Clock::time_point start;
+        bool killed = false;
+        std::string output;
+    };
+
+    // Failure text a child leaves for the parent, one slot per case, in a
+    // MAP_SHARED region mapped before forking.
+    static constexpr size_t MESSAGE_BYTES = 512;
+
+    class MessageArea {
+    private:
+        char* base = nullptr;
+        size_t bytes = 0;
+
+    public:
+        explicit MessageArea(size_t slots) : bytes(std::max<size_t>(slots, 1) * MESSAGE_BYTES) {
+            void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (mapped == MAP_FAILED) {
+                throw std::system_error(errno, std::generic_category(), "mmap test messages");
+            }
+            base = static_cast<char*>(mapped);
+        }
+
+        ~MessageArea() { munmap(base, bytes); }
+
+        MessageArea(const MessageArea&) = delete;
+        MessageArea& operator=(const MessageArea&) = delete;
+
+        char* slot(size_t index) { return base + index * MESSAGE_BYTES; }
+    };
+
+    std::string suite_name;
+    Options options;
+    std::vector<Case> cases;
+    std::vector<Result> results;
+    std::string json_path;
+    std::string filter;
+    double total_ms = 0;
+
+    static std::string json_escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    static double elapsed_ms(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    static void flush_all() {
+        OutputSink::standard().flush();
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+    }
+
+    // Runs the body; false and `failure` set if it threw.
+    static bool run_body(const Case& test, std::string& failure) {
+        try {
+            test.body();
+            return true;
+        } catch (const std::exception& e) {
+            failure = e.what();
+        } catch (...) {
+            failure = "unknown exception";
+        }
+        return false;
+    }
+
+    static bool leaks_found() {
+#ifdef __SANITIZE_ADDRESS__
+        return __lsan_do_recoverable_leak_check() != 0;
+#else
+        return false;
+#endif
+    }
+
+    // In the child: runs the case with stdout/stderr on the pipe, leaves
+    // any failure text in `message` and exits 0 or 1.
+    [[noreturn]] static void run_child(const Case& test, int output_fd, char* message) {
+        dup2(output_fd, STDOUT_FILENO);
+        dup2(output_fd, STDERR_FILENO);
+        close(output_fd);
+        std::string failure;
+        bool passed = run_body(test, failure);
+        if (passed && leaks_found()) {
+            passed = false;
+            failure = "LeakSanitizer reported leaks";
+        }
+        flush_all();
+        size_t length = std::min(failure.size(), MESSAGE_BYTES - 1);
+        std::memcpy(message, failure.data(), length);
+        message[length] = '\0';
+        _exit(passed ? 0 : 1);
+    }
+
+    void print(const Result& result) {
+        OutputSink& sink = OutputSink::standard();
+        sink << result.output;
+        char row[160];
+        std::snprintf(row, sizeof(row), "%s %-9s %-32s %9.2f ms %8ld KiB peak RSS\n",
+                      result.passed() ? "✓" : "✗", status_name(result.status), result.name.c_str(),
+                      result.wall_ms, result.peak_rss_kb);
+        sink << row;
+        if (!result.message.empty()) {
+            sink << "    " << result.message << "\n";
+        }
+        sink.flush();
+    }
+
+    void run_in_process(const std::vector<size_t>& selected) {
+        for (size_t slot = 0; slot < selected.size(); ++slot) {
+            const Case& test = cases[selected[slot]];
+            Result& result = results[slot];
+            Clock::time_point start = Clock::now();
+            if (!run_body(test, result.message)) {
+                result.status = Status::Failed;
+            }
+            result.wall_ms = elapsed_ms(start);
+            flush_all();
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            result.peak_rss_kb = usage.ru_maxrss;
+            print(result);
+        }
+    }
+
+    // Forks the case into `child`; false (and the result failed) if the
+    // pipe or fork can't be had.
+    bool spawn(size_t slot, const Case& test, char* message, Child& child) {
+        int pipe_fds[2];
+        if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+            results[slot].status = Status::Failed;
+            results[slot].message = std::string("pipe: ") + std::strerror(errno);
+            return false;
+        }
+        Clock::time_point start = Clock::now();
+        pid_t pid = fork();
+        if (pid < 0) {
+            results[slot].status = Status::Failed;
+            results[slot].message = std::string("fork: ") + std::strerror(errno);
+            close(pipe_fds[0]);
+            close(pipe_fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            run_child(test, pipe_fds[1], message);
+        }
+        close(pipe_fds[1]);
+        child = Child{slot, pid, pipe_fds[0], start, false, std::string()};
+        return true;
+    }
+
+    // Reaps a child whose output pipe hit EOF and fills in its result.
+    void finish(Child& child, const char* message) {
+        close(child.fd);
+        int status = 0;
+        rusage usage{};
+        while (wait4(child.pid, &status, 0, &usage) < 0 && errno == EINTR) {
+        }
+        Result& result = results[child.slot];
+        result.wall_ms = elapsed_ms(child.start);
+        result.peak_rss_kb = usage.ru_maxrss;
+        result.output = std::move(child.output);
+        if (child.killed) {
+            result.status = Status::TimedOut;
+            char text[64];
+            std::snprintf(text, sizeof(text), "killed after %g s", options.timeout_seconds);
+            result.message = text;
+        } else if (WIFSIGNALED(status)) {
+            result.status = Status::Crashed;
+            result.message = std::string("signal ") + std::to_string(WTERMSIG(status)) + " ("
+                             + strsignal(WTERMSIG(status)) + ")";
+        } else if (WEXITSTATUS(status) != 0) {
+            result.status = Status::Failed;
+            result.message = message[0] ? std::string(message)
+                                        : "exit code " + std::to_string(WEXITSTATUS(status));
+        }
+        print(result);
+    }
+
+    void run_isolated(const std::vector<size_t>& selected) {
+        MessageArea messages(selected.size());
+        const auto timeout = std::chrono::duration<double>(options.timeout_seconds);
+        std::vector<Child> running;
+        size_t next = 0;
+        flush_all();        // or the children inherit and repeat buffered output
+        while (next < selected.size() || !running.empty()) {
+            while (next < selected.size() && running.size() < options.jobs) {
+                Child child{};
+                if (spawn(next, cases[selected[next]], messages.slot(next), child)) {
+                    running.push_back(std::move(child));
+                } else {
+                    print(results[next]);
+                }
+                ++next;
+            }
+            if (running.empty()) {
+                continue;
+            }
+
+            // Sleep until some child writes or exits, or the nearest deadline.
+            std::vector<pollfd> fds;
+            int wait_ms = -1;
+            for (const Child& child : running) {
+                fds.push_back(pollfd{child.fd, POLLIN, 0});
+                if (options.timeout_seconds > 0 && !child.killed) {
+                    std::chrono::duration<double, std::milli> left = timeout - (Clock::now() - child.start);
+                    int ms = static_cast<int>(std::max(0.0, left.count())) + 1;
+                    wait_ms = wait_ms < 0 ? ms : std::min(wait_ms, ms);
+                }
+            }
+            if (poll(fds.data(), fds.size(), wait_ms) < 0 && errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "poll");
+            }
+
+            for (size_t i = running.size(); i-- > 0;) {
+                Child& child = running[i];
+                if (fds[i].revents) {
+                    char buffer[4096];
+                    ssize_t got = read(child.fd, buffer, sizeof(buffer));
+                    if (got > 0) {
+                        child.output.append(buffer, static_cast<size_t>(got));
+                        continue;
+                    }
+                    if (got < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    finish(child, messages.slot(child.slot));
+                    running.erase(running.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+                if (options.timeout_seconds > 0 && !child.killed && Clock::now() - child.start > timeout) {
+                    kill(child.pid, SIGKILL);
+                    child.killed = true;
+                }
+            }
+        }
+    }
+
+public:
+    Runner(std::string name, int argc = 0, char** argv = nullptr, Options opts = Options())
+        : suite_name(std::move(name)), options(opts) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--json=", 0) == 0) {
+                json_path = arg.substr(7);
+            } else if (arg.rfind("--jobs=", 0) == 0) {
+                options.jobs = static_cast<unsigned>(std::max(1, std::atoi(arg.c_str() + 7)));
+            } else if (arg.rfind("--timeout=", 0) == 0) {
+                options.timeout_seconds = std::atof(arg.c_str() + 10);
+            } else if (arg.rfind("--filter=", 0) == 0) {
+                filter = arg.substr(9);
+            } else if (arg == "--no-fork") {
+                options.isolate = false;
+            }
+        }
+        if (options.jobs == 0) {
+            options.jobs = static_cast<unsigned>(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+        }
+    }
+
+    Runner(const Runner&) = delete;
+    Runner& operator=(const Runner&) = delete;
+
+    void add(std::string name, std::function<void()> body) {
+        cases.push_back(Case{std::move(name), std::move(body)});
+    }
+
+    // Runs every case that matches the filter, prints a line per case as it
+    // finishes and returns how many did not pass.
+    size_t run() {
+        std::vector<size_t> selected;
+        for (size_t i = 0; i < cases.size(); ++i) {
+            if (cases[i].name.find(filter) != std::string::npos) {
+                selected.push_back(i);
+            }
+        }
+        results.assign(selected.size(), Result());
+        for (size_t slot = 0; slot < selected.size(); ++slot) {
+            results[slot].name = cases[selected[slot]].name;
+        }
+
+        Clock::time_point start = Clock::now();
+        if (options.isolate) {
+            run_isolated(selected);
+        } else {
+            run_in_process(selected);
+        }
+        total_ms = elapsed_ms(start);
+
+        size_t failures = 0;
+        for (const Result& result : results) {
+            failures += result.passed() ? 0 : 1;
+        }
+        OutputSink& sink = OutputSink::standard();
+        char mode[48];
+        if (options.isolate) {
+            std::snprintf(mode, sizeof(mode), "forked, %u at a time", options.jobs);
+        } else {
+            std::snprintf(mode, sizeof(mode), "in process");
+        }
+        char row[160];
+        std::snprintf(row, sizeof(row), "%zu cases, %zu failed, %.2f ms (%s)\n", results.size(), failures,
+                      total_ms, mode);
+        sink << row;
+        sink.flush();
+
+        if (!json_path.empty()) {
+            std::ofstream out(json_path);
+            write_json(out);
+        }
+        return failures;
+    }
+
+    const std::vector<Result>& all() const { return results; }
+    const Options& settings() const { return options; }
+
+    void write_json(std::ostream& out) const {
+        out << "{\"suite\": \"" << json_escape(suite_name) << "\""
+            << ", \"isolated\": " << (options.isolate ? "true" : "false")
+            << ", \"jobs\": " << (options.isolate ? options.jobs : 1)
+            << ", \"wall_ms\": " << total_ms << ", \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << (i ? ",\n  " : "\n  ")
+                << "{\"name\": \"" << json_escape(r.name) << "\""
+                << ", \"status\": \"" << status_name(r.status) << "\""
+                << ", \"wall_ms\": " << r.wall_ms
+                << ", \"peak_rss_kb\": " << r.peak_rss_kb
+                << ", \"message\": \"" << json_escape(r.message) << "\"}";
+        }
+        out << "\n]}\n";
+    }
+};
+
+} // namespace test_runner
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+echo "=== SIMD Kernel Equivalence Tests ==="
+echo "Every SSE2/AVX2 kernel must return exactly what the scalar one does"
+echo ""
+
+SOURCE_FILE="simd_equivalence.cpp"
+
+if [ ! -f "$SOURCE_FILE" ]; then
+    echo "Error: $SOURCE_FILE not found!"
+    exit 1
+fi
+
+failures=0
+
+# check LABEL BINARY ARGS...: the run must exit 0 with no sanitizer report
+check() {
+    label="$1"
+    shift
+    output=$("$@" 2>&1)
+    status=$?
+    if [ $status -eq 0 ] && ! echo "$output" | grep -q "Sanitizer"; then
+        echo "  ✓ $label: $(echo "$output" | tail -1)"
+    else
+        echo "  ✗ $label failed (exit $status)"
+        echo "$output" | grep -m5 "ERROR\|FAILED" | sed 's/^/      /'
+        failures=$((failures + 1))
+    fi
+}
+
+echo "1. AddressSanitizer + UBSan..."
+if g++ -std=c++17 -g -O1 -fsanitize=address,undefined "$SOURCE_FILE" -o simd_asan; then
+    check "sizes 0-299, aligned and offset" ./simd_asan
+else
+    echo "✗ Compilation failed with ASan"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "2. Release build..."
+if g++ -std=c++17 -O2 "$SOURCE_FILE" -o simd_release; then
+    check "sizes 0-299, aligned and offset" ./simd_release
+else
+    echo "✗ Release compilation failed"
+    failures=$((failures + 1))
+fi
+echo ""
+
+rm -f simd_asan simd_release
+
+if [ $failures -eq 0 ]; then
+    echo "=== All SIMD checks passed ==="
+else
+    echo "=== $failures SIMD check(s) failed ==="
+    exit 1
+fi
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+echo "=== SlotMap Churn Tests ==="
+echo "Insert/erase churn must reuse slots forever and keep stale handles stale"
+echo ""
+
+SOURCE_FILE="slot_map_churn.cpp"
+
+if [ ! -f "$SOURCE_FILE" ]; then
+    echo "Error: $SOURCE_FILE not found!"
+    exit 1
+fi
+
+failures=0
+
+# check LABEL BINARY ARGS...: the run must exit 0 with no sanitizer report
+check() {
+    label="$1"
+    shift
+    output=$("$@" 2>&1)
+    status=$?
+    if [ $status -eq 0 ] && ! echo "$output" | grep -q "Sanitizer"; then
+        echo "  ✓ $label: $(echo "$output" | tail -1)"
+    else
+        echo "  ✗ $label failed (exit $status)"
+        echo "$output" | grep -m5 "ERROR\|grew\|stale\|size\|FAILED" | sed 's/^/      /'
+        failures=$((failures + 1))
+    fi
+}
+
+echo "1. AddressSanitizer + UBSan..."
+if g++ -std=c++17 -g -O1 -fsanitize=address,undefined "$SOURCE_FILE" -o slot_map_asan; then
+    check "1 live object" ./slot_map_asan 2000000 1
+    check "5000 live objects" ./slot_map_asan 100000 5000
+else
+    echo "✗ Compilation failed with ASan"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "2. Release build (far past the old 255-reuse limit)..."
+if g++ -std=c++17 -O2 "$SOURCE_FILE" -o slot_map_release; then
+    check "1 live object" ./slot_map_release 10000000 1
+    check "100 live objects" ./slot_map_release 10000000 100
+else
+    echo "✗ Release compilation failed"
+    failures=$((failures + 1))
+fi
+echo ""
+
+rm -f slot_map_asan slot_map_release
+
+if [ $failures -eq 0 ]; then
+    echo "=== All SlotMap checks passed ==="
+else
+    echo "=== $failures SlotMap check(s) failed ==="
+    exit 1
+fi
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+echo "=== small_vector Exception-Safety Tests ==="
+echo "A throw at any element construction must leave vectors unchanged (or, for move assignment, valid)"
+echo ""
+
+SOURCE_FILE="small_vector_exceptions.cpp"
+
+if [ ! -f "$SOURCE_FILE" ]; then
+    echo "Error: $SOURCE_FILE not found!"
+    exit 1
+fi
+
+failures=0
+
+# check LABEL BINARY ARGS...: the run must exit 0 with no sanitizer report
+check() {
+    label="$1"
+    shift
+    output=$("$@" 2>&1)
+    status=$?
+    if [ $status -eq 0 ] && ! echo "$output" | grep -q "Sanitizer"; then
+        echo "  ✓ $label: $(echo "$output" | tail -1)"
+    else
+        echo "  ✗ $label failed (exit $status)"
+        echo "$output" | grep -m5 "ERROR\|FAILED" | sed 's/^/      /'
+        failures=$((failures + 1))
+    fi
+}
+
+echo "1. AddressSanitizer + UBSan..."
+if g++ -std=c++17 -g -O1 -fsanitize=address,undefined "$SOURCE_FILE" -o small_vector_asan; then
+    check "below, at and above N" ./small_vector_asan
+else
+    echo "✗ Compilation failed with ASan"
+    failures=$((failures + 1))
+fi
+echo ""
+
+echo "2. Release build..."
+if g++ -std=c++17 -O2 "$SOURCE_FILE" -o small_vector_release; then
+    check "below, at and above N" ./small_vector_release
+else
+    echo "✗ Release compilation failed"
+    failures=$((failures + 1))
+fi
+echo ""
+
+rm -f small_vector_asan small_vector_release
+
+if [ $failures -eq 0 ]; then
+    echo "=== All small_vector checks passed ==="
+else
+    echo "=== $failures small_vector check(s) failed ==="
+    exit 1
+fi
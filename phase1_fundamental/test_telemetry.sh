@@ -0,0 +1,48 @@
+#!/bin/bash
+
+echo "=== Memory Telemetry Timelines ==="
+echo "Builds the tests and the pool/heap benchmarks with -DMEMORY_TELEMETRY"
+echo "and checks every timeline has its samples and begin/end markers"
+echo ""
+
+failures=0
+INTERVAL_MS=${INTERVAL_MS:-5}
+
+# record NAME SOURCE [ARGS...]: build, run, write NAME.telemetry.csv
+record() {
+    name=$1
+    source=$2
+    shift 2
+    if ! g++ -std=c++17 -O2 -DMEMORY_TELEMETRY "$source" -o "$name.telemetry" -pthread; then
+        echo "✗ $name: compilation failed"
+        failures=$((failures + 1))
+        return
+    fi
+    MEMORY_TELEMETRY="$name.telemetry.csv" MEMORY_TELEMETRY_INTERVAL_MS=$INTERVAL_MS \
+        ./"$name.telemetry" "$@" > /dev/null
+    rm -f "$name.telemetry"
+
+    csv="$name.telemetry.csv"
+    samples=$(($(wc -l < "$csv") - 1))
+    begins=$(grep -c ' begin"' "$csv")
+    ends=$(grep -c ' end"' "$csv")
+    peak=$(cut -d, -f7 "$csv" | sort -n | tail -1)
+    if [ "$samples" -gt 0 ] && [ "$begins" -gt 0 ] && [ "$begins" -eq "$ends" ]; then
+        echo "✓ $name: $samples samples, $begins marked sections, peak RSS ${peak} KiB -> $csv"
+    else
+        echo "✗ $name: $samples samples, $begins begin / $ends end markers"
+        failures=$((failures + 1))
+    fi
+}
+
+record memory_test_cases memory_test_cases.cpp --no-fork
+record pool_benchmark pool_benchmark.cpp
+record performance_comparison performance_comparison.cpp
+
+echo ""
+if [ $failures -eq 0 ]; then
+    echo "All timelines recorded"
+else
+    echo "$failures timeline(s) failed"
+    exit 1
+fi